@@ -0,0 +1,413 @@
+#include "board.h"
+#include "cellkernel.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define TASK_TILES 8                 // Active tiles per thread pool task
+#define PARALLEL_MIN_CELLS (1 << 20) // Less active cells are stepped on one thread
+#define HASH_PRIME1 0x9E3779B185EBCA87ULL
+#define HASH_PRIME2 0xC2B2AE3D27D4EB4FULL
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct WorkerSum {
+  _Alignas(64) long long value;
+  long long births;
+  uint64_t hash;
+};
+
+typedef int (*StepTileFunc)(Board *board, int tile, int *births);
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+static uint64_t hashTile(const Board *board, int tile);
+static void rehashBoard(Board *board);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+Board *createBoard(int rows, int cols) {
+  Board *board = calloc(1, sizeof(Board));
+  if (!board)
+    return NULL;
+
+  board->rows = rows;
+  board->cols = cols;
+  board->words = (cols + 63) / 64;
+  board->lastWordMask = ~0ULL >> (board->words * 64 - cols);
+  board->tilesX = board->words;
+  board->tilesY = (rows + TILE_ROWS - 1) / TILE_ROWS;
+
+  size_t count = (size_t)rows * board->words;
+  size_t tiles = (size_t)board->tilesX * board->tilesY;
+  board->cells = calloc(count, sizeof(uint64_t));
+  board->next = calloc(count, sizeof(uint64_t));
+  board->tileChanged = calloc(tiles, sizeof(uint8_t));
+  board->tilePopulation = calloc(tiles, sizeof(uint16_t));
+  board->tileHash = calloc(tiles, sizeof(uint64_t));
+  board->activeTiles = calloc(tiles, sizeof(int));
+  board->workerAlive = aligned_alloc(64, sizeof(WorkerSum));
+  board->workerCount = 1;
+  if (!board->cells || !board->next || !board->tileChanged ||
+      !board->tilePopulation || !board->tileHash || !board->activeTiles ||
+      !board->workerAlive) {
+    destroyBoard(board);
+    return NULL;
+  }
+
+  setBoardRule(board, RULE_LIFE);
+  return board;
+}
+
+void destroyBoard(Board *board) {
+  if (!board)
+    return;
+
+  free(board->cells);
+  free(board->next);
+  free(board->tileChanged);
+  free(board->tilePopulation);
+  free(board->tileHash);
+  free(board->activeTiles);
+  free(board->workerAlive);
+  free(board);
+}
+
+// Both buffers are cleared, so every tile is stable and nothing is stepped
+// until cells are added again
+void clearBoard(Board *board) {
+  size_t count = (size_t)board->rows * board->words;
+  size_t tiles = (size_t)board->tilesX * board->tilesY;
+
+  memset(board->cells, 0, count * sizeof(uint64_t));
+  memset(board->next, 0, count * sizeof(uint64_t));
+  memset(board->tileChanged, 0, tiles * sizeof(uint8_t));
+  memset(board->tilePopulation, 0, tiles * sizeof(uint16_t));
+  board->activeCount = 0;
+  board->population = 0;
+  board->edits++;
+  rehashBoard(board);
+}
+
+long long refreshBoard(Board *board) {
+  size_t tiles = (size_t)board->tilesX * board->tilesY;
+
+  memset(board->tilePopulation, 0, tiles * sizeof(uint16_t));
+  memset(board->tileChanged, 1, tiles * sizeof(uint8_t));
+  board->population = 0;
+  board->edits++;
+
+  for (int i = 0; i < board->rows; i++) {
+    const uint64_t *row = boardRow(board, i);
+    uint16_t *population =
+        &board->tilePopulation[(i / TILE_ROWS) * board->tilesX];
+    for (int w = 0; w < board->words; w++) {
+      int alive = __builtin_popcountll(row[w]);
+      population[w] += alive;
+      board->population += alive;
+    }
+  }
+
+  rehashBoard(board);
+  return board->population;
+}
+
+int toggleBoardCell(Board *board, int x, int y) {
+  uint64_t *word = &boardRow(board, y)[x >> 6];
+  int tile = getTileIndex(board, x, y);
+
+  *word ^= 1ULL << (x & 63);
+  int alive = (*word >> (x & 63)) & 1;
+
+  board->tileChanged[tile] = 1;
+  board->tilePopulation[tile] += alive ? 1 : -1;
+  board->population += alive ? 1 : -1;
+  board->edits++;
+
+  // Only the toggled tile's hash changes
+  board->hash -= board->tileHash[tile];
+  board->tileHash[tile] = hashTile(board, tile);
+  board->hash += board->tileHash[tile];
+
+  return alive;
+}
+
+// SplitMix64: a fixed generator, unlike rand(), so seeds mean the same
+// board everywhere
+static uint64_t splitMix64(uint64_t *state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+long long randomizeBoard(Board *board, uint64_t seed) {
+  for (int i = 0; i < board->rows; i++) {
+    uint64_t *row = boardRow(board, i);
+    for (int w = 0; w < board->words; w++)
+      row[w] = splitMix64(&seed);
+    row[board->words - 1] &= board->lastWordMask;
+  }
+
+  return refreshBoard(board);
+}
+
+uint64_t getBoardChecksum(const Board *board) {
+  size_t count = (size_t)board->rows * board->words;
+  uint64_t hash = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    uint64_t state = hash ^ board->cells[i];
+    hash = splitMix64(&state);
+  }
+
+  return hash;
+}
+
+void setBoardRule(Board *board, Rule rule) {
+  board->rule = rule;
+  board->ruleKernel = getRuleKernel(rule);
+  fillRuleTable(rule, board->ruleTable);
+
+  // Stable tiles may not be stable under the new rule
+  refreshBoard(board);
+}
+
+// A tile's hash starts from its index, so equal tiles in different places
+// hash differently. Each row goes through an xxHash round, which the step
+// kernels run on the rows they write, and the result is mixed once.
+static inline uint64_t startTileHash(int tile) {
+  return (uint64_t)(tile + 1) * HASH_PRIME1;
+}
+
+static inline uint64_t addTileHashRow(uint64_t hash, uint64_t row) {
+  hash += row * HASH_PRIME2;
+  hash = (hash << 31) | (hash >> 33);
+  return hash * HASH_PRIME1;
+}
+
+static inline uint64_t finishTileHash(uint64_t hash) {
+  hash = (hash ^ (hash >> 33)) * 0xFF51AFD7ED558CCDULL;
+  hash = (hash ^ (hash >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+  return hash ^ (hash >> 33);
+}
+
+static uint64_t hashTile(const Board *board, int tile) {
+  int w = tile % board->tilesX;
+  int r0 = (tile / board->tilesX) * TILE_ROWS;
+  int r1 = (r0 + TILE_ROWS < board->rows) ? r0 + TILE_ROWS : board->rows;
+  uint64_t hash = startTileHash(tile);
+
+  for (int i = r0; i < r1; i++)
+    hash = addTileHashRow(hash, boardRow(board, i)[w]);
+
+  return finishTileHash(hash);
+}
+
+static void rehashBoard(Board *board) {
+  int tiles = board->tilesX * board->tilesY;
+
+  board->hash = 0;
+  for (int i = 0; i < tiles; i++) {
+    board->tileHash[i] = hashTile(board, i);
+    board->hash += board->tileHash[i];
+  }
+}
+
+// Horizontal neighbor sums of one row for word w, wrapping around the board
+// edges
+static inline void rowSums(const uint64_t *row, int w, int last, int lastBit,
+                           uint64_t *s0, uint64_t *s1, uint64_t *m0,
+                           uint64_t *m1) {
+  uint64_t westIn = (w > 0) ? (row[w - 1] >> 63) : (row[last] >> lastBit);
+  uint64_t eastIn = (w < last) ? (row[w + 1] << 63) : ((row[0] & 1) << lastBit);
+
+  sumRow(row[w], westIn, eastIn, s0, s1, m0, m1);
+}
+
+// Steps one tile: up to TILE_ROWS rows of one 64-cell wide column. Each
+// row's horizontal sums are computed once and slid down the tile. The
+// tile's hash is updated along the way. Returns the population change of
+// the tile, and adds the cells born to *births unless it is NULL.
+//
+// The kernel is a constant in each caller, so every rule with a kernel of
+// its own gets a copy of the loop with only the logic it needs.
+static inline __attribute__((always_inline)) int
+stepTileKernel(Board *board, int tile, int *births, RuleKernel kernel) {
+  const uint64_t *cells = board->cells;
+  uint64_t *next = board->next;
+  int rows = board->rows, words = board->words;
+  int w = tile % board->tilesX;
+  int r0 = (tile / board->tilesX) * TILE_ROWS;
+  int r1 = (r0 + TILE_ROWS < rows) ? r0 + TILE_ROWS : rows;
+  int last = words - 1, lastBit = (board->cols - 1) & 63;
+  uint64_t mask = (w == last) ? board->lastWordMask : ~0ULL;
+  uint64_t changed = 0, hash = startTileHash(tile);
+  uint64_t aliveLanes = 0, bornLanes = 0;
+  int countBirths = (births != NULL);
+  uint64_t a0, a1, m0, m1, b0, b1;
+
+  const uint64_t *up = cells + (size_t)((r0 > 0) ? r0 - 1 : rows - 1) * words;
+  rowSums(up, w, last, lastBit, &a0, &a1, &m0, &m1);
+  rowSums(cells + (size_t)r0 * words, w, last, lastBit, &b0, &b1, &m0, &m1);
+
+  for (int i = r0; i < r1; i++) {
+    uint64_t c0 = b0, c1 = b1, cm0 = m0, cm1 = m1;
+    const uint64_t *down = cells + (size_t)((i + 1 < rows) ? i + 1 : 0) * words;
+    rowSums(down, w, last, lastBit, &b0, &b1, &m0, &m1);
+
+    size_t k = (size_t)i * words + w;
+    uint64_t self = cells[k];
+    uint64_t cell = nextCells(kernel, board->ruleTable, self, a0, a1, cm0, cm1,
+                              b0, b1) &
+                    mask;
+    next[k] = cell;
+    changed |= cell ^ self;
+    aliveLanes += countLanes(cell);
+    if (countBirths)
+      bornLanes += countLanes(cell & ~self);
+    hash = addTileHashRow(hash, cell);
+
+    a0 = c0;
+    a1 = c1;
+  }
+
+  int alive = sumLanes(aliveLanes);
+  int delta = alive - board->tilePopulation[tile];
+  board->tilePopulation[tile] = (uint16_t)alive;
+  board->tileChanged[tile] = (changed != 0);
+  board->tileHash[tile] = finishTileHash(hash);
+  if (countBirths)
+    *births += sumLanes(bornLanes);
+
+  return delta;
+}
+
+static int stepTileLife(Board *board, int tile, int *births) {
+  return stepTileKernel(board, tile, births, KERNEL_LIFE);
+}
+
+static int stepTileHighLife(Board *board, int tile, int *births) {
+  return stepTileKernel(board, tile, births, KERNEL_HIGHLIFE);
+}
+
+static int stepTileDayAndNight(Board *board, int tile, int *births) {
+  return stepTileKernel(board, tile, births, KERNEL_DAY_AND_NIGHT);
+}
+
+static int stepTileTable(Board *board, int tile, int *births) {
+  return stepTileKernel(board, tile, births, KERNEL_TABLE);
+}
+
+static const StepTileFunc stepTileKernels[] = {
+    stepTileLife, stepTileHighLife, stepTileDayAndNight, stepTileTable};
+
+// A task is a run of up to TASK_TILES active tiles. The active list is in
+// board order, so tasks running on different threads mostly write to
+// different cache lines.
+static void stepTask(void *ctx, int task, int worker) {
+  Board *board = ctx;
+  int begin = task * TASK_TILES;
+  int end = (begin + TASK_TILES < board->activeCount) ? begin + TASK_TILES
+                                                      : board->activeCount;
+  StepTileFunc stepTile = stepTileKernels[board->ruleKernel];
+  long long delta = 0;
+  int births = 0;
+  uint64_t hashDelta = 0;
+
+  for (int i = begin; i < end; i++) {
+    int tile = board->activeTiles[i];
+    uint64_t hash = board->tileHash[tile];
+    delta += stepTile(board, tile, board->countBirths ? &births : NULL);
+    hashDelta += board->tileHash[tile] - hash;
+  }
+
+  // Per-worker partial sums, reduced once the whole step is done
+  board->workerAlive[worker].value += delta;
+  board->workerAlive[worker].births += births;
+  board->workerAlive[worker].hash += hashDelta;
+}
+
+// A tile must be stepped if it or any of its 8 neighbors (wrapping around
+// the board) changed. The others keep their cells, and since they did not
+// change in the last step either, the back buffer already holds those cells.
+static void collectActiveTiles(Board *board) {
+  int tilesX = board->tilesX, tilesY = board->tilesY;
+  uint8_t *changed = board->tileChanged;
+
+  board->activeCount = 0;
+  for (int ty = 0; ty < tilesY; ty++) {
+    int up = ((ty > 0) ? ty - 1 : tilesY - 1) * tilesX;
+    int mid = ty * tilesX;
+    int down = ((ty + 1 < tilesY) ? ty + 1 : 0) * tilesX;
+
+    for (int tx = 0; tx < tilesX; tx++) {
+      int west = (tx > 0) ? tx - 1 : tilesX - 1;
+      int east = (tx + 1 < tilesX) ? tx + 1 : 0;
+
+      if (changed[up + west] | changed[up + tx] | changed[up + east] |
+          changed[mid + west] | changed[mid + tx] | changed[mid + east] |
+          changed[down + west] | changed[down + tx] | changed[down + east])
+        board->activeTiles[board->activeCount++] = mid + tx;
+    }
+  }
+
+  // Tiles that are not stepped will not change in this generation
+  for (int i = 0, a = 0; i < tilesX * tilesY; i++) {
+    if (a < board->activeCount && board->activeTiles[a] == i)
+      a++;
+    else
+      changed[i] = 0;
+  }
+}
+
+long long stepBoard(Board *board, ThreadPool *pool) {
+  int threads = getThreadPoolSize(pool);
+
+  collectActiveTiles(board);
+
+  // A few active tiles step faster than the pool can wake up
+  if ((long long)board->activeCount * TILE_ROWS * 64 < PARALLEL_MIN_CELLS)
+    pool = NULL, threads = 1;
+
+  if (threads > board->workerCount) {
+    WorkerSum *sums = aligned_alloc(64, threads * sizeof(WorkerSum));
+    if (sums) {
+      free(board->workerAlive);
+      board->workerAlive = sums;
+      board->workerCount = threads;
+    } else {
+      pool = NULL, threads = 1;
+    }
+  }
+
+  for (int i = 0; i < threads; i++) {
+    board->workerAlive[i].value = 0;
+    board->workerAlive[i].births = 0;
+    board->workerAlive[i].hash = 0;
+  }
+
+  int tasks = (board->activeCount + TASK_TILES - 1) / TASK_TILES;
+  runThreadPool(pool, tasks, stepTask, board);
+
+  board->births = board->countBirths ? 0 : -1;
+  for (int i = 0; i < threads; i++) {
+    board->population += board->workerAlive[i].value;
+    if (board->countBirths)
+      board->births += board->workerAlive[i].births;
+    board->hash += board->workerAlive[i].hash;
+  }
+
+  // The back buffer becomes the current generation, no copy needed
+  uint64_t *cells = board->next;
+  board->next = board->cells;
+  board->cells = cells;
+
+  return board->population;
+}
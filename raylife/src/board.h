@@ -0,0 +1,103 @@
+/*******************************************************************************************
+ *
+ *   Board: bit-packed toroidal Game of Life board
+ *
+ *   Cells are stored 64 per word: bit b of word w in a row holds the cell at
+ *   column w * 64 + b. Bits past the last column are always kept clear.
+ *
+ *   For stepping, the board is split into tiles of TILE_ROWS rows by one word
+ *   (64 columns), which are stepped in parallel on a thread pool. A tile is
+ *   only stepped when it or one of its 8 neighbors changed in the previous
+ *   generation: otherwise its next state is known to be its current one.
+ *
+ *   The board keeps a 64-bit hash of its cells, the sum of one hash per tile,
+ *   so a step only rehashes the tiles it stepped.
+ *
+ *   Any B/S rule can be run. Conway's Life, HighLife and Day & Night have
+ *   stepping kernels of their own, other rules go through a lookup table.
+ *
+ *******************************************************************************************/
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rule.h"
+#include "threadpool.h"
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define TILE_ROWS 64
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct WorkerSum WorkerSum;
+
+typedef struct {
+  int rows;
+  int cols;
+  int words;                // Words per row
+  uint64_t lastWordMask;    // Valid bits of the last word of each row
+  uint64_t *cells;          // Front buffer: current generation
+  uint64_t *next;           // Back buffer: next generation, swapped by pointer
+  int tilesX;               // Tile columns, one per word
+  int tilesY;               // Tile rows, TILE_ROWS board rows each
+  uint8_t *tileChanged;     // Tile changed in the last step or was edited
+  uint16_t *tilePopulation; // Alive cells per tile
+  uint64_t *tileHash;       // Hash of each tile's cells and position
+  int *activeTiles;         // Tiles stepped in the last generation
+  int activeCount;
+  long long population;
+  long long births;         // Cells born in the last step, -1 unless
+                            // countBirths is set. The rest of the population
+                            // change are deaths.
+  int countBirths;          // Counting births slows steps down a little
+  uint64_t hash;            // Sum of the tile hashes: equal boards, equal hash
+  unsigned edits;           // Counts writes to the cells other than steps
+  WorkerSum *workerAlive;   // Per-thread population deltas of the running step
+  int workerCount;
+  Rule rule;
+  int ruleKernel;           // Stepping kernel specialized for the rule
+  uint64_t ruleTable[32];   // Next state of 64 cells by alive << 4 | neighbors
+} Board;
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// Returns NULL on allocation failure. The rule is Conway's Life.
+Board *createBoard(int rows, int cols);
+void destroyBoard(Board *board);
+void clearBoard(Board *board);
+// Call after writing board->cells directly: recounts every tile and marks
+// them all as changed. Returns the number of alive cells.
+long long refreshBoard(Board *board);
+// Steps one generation on the given pool (NULL steps on the calling thread)
+// and returns the new number of alive cells
+long long stepBoard(Board *board, ThreadPool *pool);
+// Every tile is stepped again after a rule change
+void setBoardRule(Board *board, Rule rule);
+// Flips a cell and returns its new state
+int toggleBoardCell(Board *board, int x, int y);
+// Fills the board with random cells, about half alive, reproducible for a
+// given seed on every platform. Returns the number of alive cells.
+long long randomizeBoard(Board *board, uint64_t seed);
+// 64-bit hash of all cells, equal for equal boards of the same size
+uint64_t getBoardChecksum(const Board *board);
+
+static inline uint64_t *boardRow(const Board *board, int y) {
+  return board->cells + (size_t)y * board->words;
+}
+
+static inline int getBoardCell(const Board *board, int x, int y) {
+  return (boardRow(board, y)[x >> 6] >> (x & 63)) & 1;
+}
+
+static inline int getTileIndex(const Board *board, int x, int y) {
+  return (y / TILE_ROWS) * board->tilesX + (x >> 6);
+}
+
+#endif // BOARD_H
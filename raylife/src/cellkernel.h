@@ -0,0 +1,149 @@
+/*******************************************************************************************
+ *
+ *   Cell kernel: steps 64 cells per word operation
+ *
+ *   Shared by the board and the plane. Cells are counted with bitwise full
+ *   adders: a row's horizontal sums (west + self + east) are computed once
+ *   and added to the rows above and below, then the rule picks the next
+ *   state of all 64 cells of a word at once.
+ *
+ *   Conway's Life, HighLife and Day & Night have kernels of their own, other
+ *   rules go through a lookup table. Callers pass the kernel as a constant,
+ *   so each gets a loop with only the logic it needs.
+ *
+ *******************************************************************************************/
+
+#ifndef CELLKERNEL_H
+#define CELLKERNEL_H
+
+#include <stdint.h>
+
+#include "rule.h"
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef enum {
+  KERNEL_LIFE = 0,
+  KERNEL_HIGHLIFE,
+  KERNEL_DAY_AND_NIGHT,
+  KERNEL_TABLE, // Any other rule
+} RuleKernel;
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+static inline RuleKernel getRuleKernel(Rule rule) {
+  if (isSameRule(rule, RULE_LIFE))
+    return KERNEL_LIFE;
+  if (isSameRule(rule, RULE_HIGHLIFE))
+    return KERNEL_HIGHLIFE;
+  if (isSameRule(rule, RULE_DAY_AND_NIGHT))
+    return KERNEL_DAY_AND_NIGHT;
+
+  return KERNEL_TABLE;
+}
+
+// Next state of 64 cells by alive << 4 | neighbors, for KERNEL_TABLE
+static inline void fillRuleTable(Rule rule, uint64_t table[32]) {
+  for (int i = 0; i < 32; i++) {
+    int alive = i >> 4, neighbors = i & 15;
+    table[i] = (neighbors <= 8 && getRuleNextState(rule, alive, neighbors))
+                   ? ~0ULL
+                   : 0;
+  }
+}
+
+// Horizontal neighbor sums of a word, given the bit shifted in from the west
+// word (at bit 0) and the east word (at bit 63). (s1:s0) counts west + self
+// + east, (m1:m0) counts west + east only.
+static inline void sumRow(uint64_t c, uint64_t westIn, uint64_t eastIn,
+                          uint64_t *s0, uint64_t *s1, uint64_t *m0,
+                          uint64_t *m1) {
+  uint64_t west = (c << 1) | westIn;
+  uint64_t east = (c >> 1) | eastIn;
+
+  *m0 = west ^ east;
+  *m1 = west & east;
+  *s0 = *m0 ^ c;
+  *s1 = *m1 | (*m0 & c);
+}
+
+static inline uint64_t mux(uint64_t a, uint64_t b, uint64_t select) {
+  return a ^ ((a ^ b) & select);
+}
+
+// Looks up the rule table for 64 cells at once: a tree of multiplexers picks
+// entry (alive << 4 | neighbors) for every bit, one count bit per level
+static inline uint64_t lookupRule(const uint64_t *table, uint64_t alive,
+                                  uint64_t ones, uint64_t twos, uint64_t fours,
+                                  uint64_t eights) {
+  uint64_t level[16];
+
+  for (int i = 0; i < 16; i++)
+    level[i] = mux(table[2 * i], table[2 * i + 1], ones);
+  for (int i = 0; i < 8; i++)
+    level[i] = mux(level[2 * i], level[2 * i + 1], twos);
+  for (int i = 0; i < 4; i++)
+    level[i] = mux(level[2 * i], level[2 * i + 1], fours);
+  for (int i = 0; i < 2; i++)
+    level[i] = mux(level[2 * i], level[2 * i + 1], eights);
+
+  return mux(level[0], level[1], alive);
+}
+
+// Bit counts of a word in four 16-bit lanes. A tile's rows add up lane by
+// lane without overflowing, and sumLanes() totals them once, which is much
+// cheaper than a popcount call per word on CPUs built without a popcount
+// instruction.
+static inline uint64_t countLanes(uint64_t x) {
+  x -= (x >> 1) & 0x5555555555555555ULL;
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (x + (x >> 8)) & 0x00FF00FF00FF00FFULL;
+}
+
+static inline int sumLanes(uint64_t lanes) {
+  return (int)((lanes * 0x0001000100010001ULL) >> 48);
+}
+
+// Next state of a word from the sums of the row above (a), its own row
+// without self (cm) and the row below (b)
+static inline __attribute__((always_inline)) uint64_t
+nextCells(RuleKernel kernel, const uint64_t *table, uint64_t self, uint64_t a0,
+          uint64_t a1, uint64_t cm0, uint64_t cm1, uint64_t b0, uint64_t b1) {
+  // Ones: a0 + cm0 + b0, carry goes to the twos
+  uint64_t t = a0 ^ cm0;
+  uint64_t ones = t ^ b0;
+  uint64_t carry = (a0 & cm0) | (t & b0);
+
+  // Twos: a1 + cm1 + b1 + carry, pairs of them carry to the fours. Only
+  // one of q, s and p & r can be set with another, q and s (8 neighbors).
+  uint64_t p = a1 ^ cm1, q = a1 & cm1;
+  uint64_t r = b1 ^ carry, s = b1 & carry;
+  uint64_t twos = p ^ r;
+
+  if (kernel == KERNEL_LIFE) {
+    // Alive with 2 or 3 neighbors, or dead with exactly 3
+    uint64_t overflow = q | s | (p & r);
+    return twos & ~overflow & (ones | self);
+  }
+
+  uint64_t fours = q ^ s ^ (p & r);
+  uint64_t eights = q & s;
+  uint64_t twoOrThree = twos & ~fours & ~eights;
+
+  if (kernel == KERNEL_HIGHLIFE) {
+    // Life, plus births on 6 neighbors
+    return (twoOrThree & (ones | self)) | (~self & fours & twos & ~ones);
+  }
+  if (kernel == KERNEL_DAY_AND_NIGHT) {
+    // 3, 6, 7 or 8 neighbors, or alive with 4
+    return (twoOrThree & ones) | (fours & twos) | eights |
+           (self & fours & ~twos & ~ones);
+  }
+
+  return lookupRule(table, self, ones, twos, fours, eights);
+}
+
+#endif // CELLKERNEL_H
@@ -0,0 +1,82 @@
+#include "cycle.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct {
+  uint64_t hash;
+  long long generation; // -1 for an empty slot
+} CycleEntry;
+
+struct CycleDetector {
+  CycleEntry *entries;
+  int mask; // Capacity - 1
+  int count;
+};
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+CycleDetector *createCycleDetector(int capacity) {
+  CycleDetector *cycles = calloc(1, sizeof(CycleDetector));
+  if (!cycles)
+    return NULL;
+
+  int size = 16;
+  while (size < capacity)
+    size <<= 1;
+
+  cycles->mask = size - 1;
+  cycles->entries = malloc(size * sizeof(CycleEntry));
+  if (!cycles->entries) {
+    free(cycles);
+    return NULL;
+  }
+
+  resetCycleDetector(cycles);
+  return cycles;
+}
+
+void destroyCycleDetector(CycleDetector *cycles) {
+  if (!cycles)
+    return;
+
+  free(cycles->entries);
+  free(cycles);
+}
+
+void resetCycleDetector(CycleDetector *cycles) {
+  // All bytes 0xFF make every generation -1
+  memset(cycles->entries, 0xFF, (cycles->mask + 1) * sizeof(CycleEntry));
+  cycles->count = 0;
+}
+
+long long checkCycle(CycleDetector *cycles, uint64_t hash, long long generation) {
+  // Board hashes are already well mixed, the top bits make the slot
+  int slot = (int)(hash >> 40) & cycles->mask;
+
+  for (;;) {
+    CycleEntry *entry = &cycles->entries[slot];
+    if (entry->generation < 0)
+      break;
+    if (entry->hash == hash)
+      return (generation > entry->generation) ? generation - entry->generation
+                                              : 0;
+    slot = (slot + 1) & cycles->mask;
+  }
+
+  // Starting over keeps probes short. A settled board refills the table
+  // with its cycle, which is then found again.
+  if (cycles->count >= (cycles->mask + 1) / 2) {
+    resetCycleDetector(cycles);
+    slot = (int)(hash >> 40) & cycles->mask;
+  }
+
+  cycles->entries[slot].hash = hash;
+  cycles->entries[slot].generation = generation;
+  cycles->count++;
+  return 0;
+}
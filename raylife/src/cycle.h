@@ -0,0 +1,44 @@
+/*******************************************************************************************
+ *
+ *   Cycle: detects when the board repeats an earlier generation
+ *
+ *   Soups settle into still lifes and oscillators, after which every further
+ *   generation is a repeat. The board hash of each generation is recorded in
+ *   a small open-addressing table, and a hash seen before gives the period:
+ *   1 for a still life, N for a period-N oscillator. The table is cleared
+ *   when half full, so periods below half its capacity are always found
+ *   once the board has settled.
+ *
+ *   A 64-bit hash match is taken as a repeat: boards that differ collide
+ *   with a chance of about 2^-64 per pair.
+ *
+ *******************************************************************************************/
+
+#ifndef CYCLE_H
+#define CYCLE_H
+
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define CYCLE_DEFAULT_CAPACITY 4096 // Finds periods below 2048
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct CycleDetector CycleDetector;
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// Capacity is rounded up to a power of 2. Returns NULL on allocation failure.
+CycleDetector *createCycleDetector(int capacity);
+void destroyCycleDetector(CycleDetector *cycles);
+// Forgets all generations, after the board was edited
+void resetCycleDetector(CycleDetector *cycles);
+// Records the hash of a generation. Returns the period if the same hash was
+// recorded at an earlier generation, 0 otherwise.
+long long checkCycle(CycleDetector *cycles, uint64_t hash, long long generation);
+
+#endif // CYCLE_H
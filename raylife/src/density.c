@@ -0,0 +1,181 @@
+#include "density.h"
+
+#include <stdlib.h>
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Blocks up to a tile hold at most 4096 cells, the ones above need 32 bits
+typedef struct {
+  int width;
+  int height;
+  uint16_t *small; // Levels up to DENSITY_TILE_LEVEL
+  uint32_t *large; // Levels above
+} DensityLevel;
+
+struct DensityPyramid {
+  int tilesX;
+  int tilesY;
+  DensityLevel *levels; // Level 0 is the cells, with no counts
+  int levelCount;
+  uint64_t *tileHash;   // Tile hashes of the last update
+  int counted;          // Whether any update happened yet
+};
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+DensityPyramid *createDensityPyramid(int rows, int cols) {
+  DensityPyramid *pyramid = calloc(1, sizeof(DensityPyramid));
+  if (!pyramid)
+    return NULL;
+
+  pyramid->tilesX = (cols + 63) / 64;
+  pyramid->tilesY = (rows + TILE_ROWS - 1) / TILE_ROWS;
+
+  // Halve the size until one block covers the board. Rows are at least one
+  // tile wide, so the tile level is always reached.
+  int width = pyramid->tilesX * 64, height = rows;
+  pyramid->levelCount = 1;
+  while (width > 1 || height > 1) {
+    width = (width + 1) / 2;
+    height = (height + 1) / 2;
+    pyramid->levelCount++;
+  }
+
+  pyramid->levels = calloc(pyramid->levelCount, sizeof(DensityLevel));
+  pyramid->tileHash =
+      calloc((size_t)pyramid->tilesX * pyramid->tilesY, sizeof(uint64_t));
+  if (!pyramid->levels || !pyramid->tileHash) {
+    destroyDensityPyramid(pyramid);
+    return NULL;
+  }
+
+  width = pyramid->tilesX * 64, height = rows;
+  for (int k = 1; k < pyramid->levelCount; k++) {
+    DensityLevel *level = &pyramid->levels[k];
+    size_t count;
+
+    width = (width + 1) / 2;
+    height = (height + 1) / 2;
+    level->width = width;
+    level->height = height;
+    count = (size_t)width * height;
+    if (k <= DENSITY_TILE_LEVEL)
+      level->small = calloc(count, sizeof(uint16_t));
+    else
+      level->large = calloc(count, sizeof(uint32_t));
+    if (!level->small && !level->large) {
+      destroyDensityPyramid(pyramid);
+      return NULL;
+    }
+  }
+
+  return pyramid;
+}
+
+void destroyDensityPyramid(DensityPyramid *pyramid) {
+  if (!pyramid)
+    return;
+
+  if (pyramid->levels) {
+    for (int k = 0; k < pyramid->levelCount; k++) {
+      free(pyramid->levels[k].small);
+      free(pyramid->levels[k].large);
+    }
+  }
+  free(pyramid->levels);
+  free(pyramid->tileHash);
+  free(pyramid);
+}
+
+int getDensityLevels(const DensityPyramid *pyramid) {
+  return pyramid->levelCount;
+}
+
+unsigned getDensityCount(const DensityPyramid *pyramid, int level, int x,
+                         int y) {
+  const DensityLevel *l = &pyramid->levels[level];
+  if (x < 0 || y < 0 || x >= l->width || y >= l->height)
+    return 0;
+
+  size_t i = (size_t)y * l->width + x;
+  return l->small ? l->small[i] : l->large[i];
+}
+
+// Sums the 4 blocks of the level below
+static void sumBlock(DensityPyramid *pyramid, int level, int x, int y) {
+  DensityLevel *l = &pyramid->levels[level];
+  unsigned count = getDensityCount(pyramid, level - 1, 2 * x, 2 * y) +
+                   getDensityCount(pyramid, level - 1, 2 * x + 1, 2 * y) +
+                   getDensityCount(pyramid, level - 1, 2 * x, 2 * y + 1) +
+                   getDensityCount(pyramid, level - 1, 2 * x + 1, 2 * y + 1);
+  size_t i = (size_t)y * l->width + x;
+
+  if (l->small)
+    l->small[i] = (uint16_t)count;
+  else
+    l->large[i] = count;
+}
+
+// Recounts the levels inside a tile. Level 1 comes from pairs of rows: each
+// row's bits are summed in pairs, spread out to 4-bit fields so the sums of
+// two rows can't overflow, even pairs in one word and odd ones in another.
+static void countTile(DensityPyramid *pyramid, const Board *view, int tx,
+                      int ty) {
+  const uint64_t pairs = 0x5555555555555555ULL;
+  const uint64_t nibbles = 0x3333333333333333ULL;
+  DensityLevel *level1 = &pyramid->levels[1];
+  int r0 = ty * TILE_ROWS;
+  int r1 = (r0 + TILE_ROWS < view->rows) ? r0 + TILE_ROWS : view->rows;
+
+  for (int i = r0; i < r1; i += 2) {
+    uint64_t a = boardRow(view, i)[tx];
+    uint64_t b = (i + 1 < r1) ? boardRow(view, i + 1)[tx] : 0;
+    a -= (a >> 1) & pairs;
+    b -= (b >> 1) & pairs;
+    uint64_t even = (a & nibbles) + (b & nibbles);
+    uint64_t odd = ((a >> 2) & nibbles) + ((b >> 2) & nibbles);
+
+    uint16_t *counts =
+        level1->small + (size_t)(i / 2) * level1->width + tx * 32;
+    for (int m = 0; m < 16; m++) {
+      counts[2 * m] = (even >> (4 * m)) & 15;
+      counts[2 * m + 1] = (odd >> (4 * m)) & 15;
+    }
+  }
+
+  for (int k = 2; k <= DENSITY_TILE_LEVEL; k++) {
+    int blocks = 64 >> k;
+    for (int y = r0 >> k; y <= (r1 - 1) >> k; y++)
+      for (int x = tx * blocks; x < (tx + 1) * blocks; x++)
+        sumBlock(pyramid, k, x, y);
+  }
+}
+
+int updateDensityPyramid(DensityPyramid *pyramid, const Board *view) {
+  int recounted = 0;
+
+  for (int ty = 0; ty < pyramid->tilesY; ty++) {
+    for (int tx = 0; tx < pyramid->tilesX; tx++) {
+      int tile = ty * pyramid->tilesX + tx;
+      if (pyramid->counted && pyramid->tileHash[tile] == view->tileHash[tile])
+        continue;
+
+      pyramid->tileHash[tile] = view->tileHash[tile];
+      countTile(pyramid, view, tx, ty);
+      recounted++;
+
+      // Blocks above the tile, shared with its neighbors
+      int x = tx, y = ty;
+      for (int k = DENSITY_TILE_LEVEL + 1; k < pyramid->levelCount; k++) {
+        x >>= 1;
+        y >>= 1;
+        sumBlock(pyramid, k, x, y);
+      }
+    }
+  }
+
+  pyramid->counted = 1;
+  return recounted;
+}
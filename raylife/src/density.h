@@ -0,0 +1,46 @@
+/*******************************************************************************************
+ *
+ *   Density: population pyramid of the board, for drawing it zoomed out
+ *
+ *   Level k counts the alive cells of each 2^k x 2^k block of cells, from
+ *   2x2 blocks at level 1 up to a single block covering the whole board.
+ *   Levels up to 6 divide each tile into blocks, and the ones above sum 4
+ *   blocks of the level below.
+ *
+ *   Updates only recount the tiles whose hash changed since the last one,
+ *   and the blocks above them, so a settled board costs a pass over the
+ *   tile hashes.
+ *
+ *******************************************************************************************/
+
+#ifndef DENSITY_H
+#define DENSITY_H
+
+#include "board.h"
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define DENSITY_TILE_LEVEL 6 // Level whose blocks are whole tiles
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct DensityPyramid DensityPyramid;
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// For boards of the given size. Returns NULL on allocation failure.
+DensityPyramid *createDensityPyramid(int rows, int cols);
+void destroyDensityPyramid(DensityPyramid *pyramid);
+// Brings the counts up to date with a board of the pyramid's size, which
+// needs its tile hashes. Returns the number of tiles recounted.
+int updateDensityPyramid(DensityPyramid *pyramid, const Board *view);
+// Levels are 1 to getDensityLevels() - 1
+int getDensityLevels(const DensityPyramid *pyramid);
+// Alive cells in block (x, y) of the level, 0 for blocks past the board
+unsigned getDensityCount(const DensityPyramid *pyramid, int level, int x,
+                         int y);
+
+#endif // DENSITY_H
@@ -0,0 +1,599 @@
+#include "hashlife.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define NIL UINT32_MAX
+#define DEAD_CELL 0 // Level 0 nodes: indices 0 and 1 are the two cell states
+#define ALIVE_CELL 1
+#define MAX_LEVEL 62
+
+// Garbage is collected before a step once this share of the budget is used,
+// leaving the rest as headroom for the nodes the step itself creates
+#define GC_THRESHOLD_NUM 3
+#define GC_THRESHOLD_DEN 4
+
+enum { NW = 0, NE, SW, SE };
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct {
+  uint32_t child[4];   // NW, NE, SW, SE quadrants, one level down
+  uint32_t next;       // Next node in the hash bucket, or in the free list
+  uint32_t level;      // Node covers 2^level x 2^level cells
+  uint64_t population; // Saturates instead of overflowing
+} Node;
+
+// Result cache set: two ways with least-recently-used replacement
+typedef struct {
+  uint32_t node[2];
+  uint32_t result[2];
+  uint8_t stepLog2[2];
+  uint8_t recent; // Way hit or filled last
+} CacheSet;
+
+struct HashLife {
+  Node *nodes;
+  uint32_t nodeCount; // Nodes ever handed out, including free ones
+  uint32_t capacity;
+  uint32_t budget;
+  uint32_t freeList;
+  long long inUse;
+
+  uint32_t *buckets;
+  uint32_t bucketMask;
+
+  CacheSet *cache;
+  uint32_t cacheMask;
+  long long cacheHits, cacheMisses, cacheEvictions;
+
+  uint32_t empty[MAX_LEVEL + 1]; // Canonical empty node of each level
+  uint32_t leaves[16];           // All level 1 nodes, by their 4 cell bits
+  uint8_t leafResult[1 << 16];   // Level 2 (4x4) to its next 2x2 center
+  Rule rule;
+
+  uint32_t root;
+  uint8_t *marks;
+  int collections;
+};
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+static inline uint32_t hashChildren(uint32_t nw, uint32_t ne, uint32_t sw,
+                                    uint32_t se) {
+  uint64_t h = nw * 0x9E3779B97F4A7C15ULL;
+  h = (h ^ ne) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ sw) * 0x94D049BB133111EBULL;
+  h = (h ^ se) * 0x9E3779B97F4A7C15ULL;
+  return (uint32_t)(h >> 32);
+}
+
+static inline uint64_t addPopulation(uint64_t a, uint64_t b) {
+  return (a + b < a) ? UINT64_MAX : a + b;
+}
+
+static void rehash(HashLife *life, uint32_t bucketCount) {
+  uint32_t *buckets = malloc(bucketCount * sizeof(uint32_t));
+  if (!buckets)
+    return; // Keep the old table, chains just get longer
+
+  free(life->buckets);
+  life->buckets = buckets;
+  life->bucketMask = bucketCount - 1;
+  memset(buckets, 0xFF, bucketCount * sizeof(uint32_t));
+
+  for (uint32_t i = 2; i < life->nodeCount; i++) {
+    Node *node = &life->nodes[i];
+    if (node->level == 0)
+      continue; // Free slot
+
+    uint32_t b = hashChildren(node->child[NW], node->child[NE], node->child[SW],
+                              node->child[SE]) &
+                 life->bucketMask;
+    node->next = buckets[b];
+    buckets[b] = i;
+  }
+}
+
+// Returns a free node slot, growing the arena if the budget is exhausted
+// in the middle of a step. Returns NIL if memory runs out.
+static uint32_t allocNode(HashLife *life) {
+  if (life->freeList != NIL) {
+    uint32_t index = life->freeList;
+    life->freeList = life->nodes[index].next;
+    return index;
+  }
+
+  if (life->nodeCount == life->capacity) {
+    if (life->capacity >= NIL / 2)
+      return NIL;
+
+    uint32_t capacity = life->capacity * 2;
+    Node *nodes = realloc(life->nodes, capacity * sizeof(Node));
+    uint8_t *marks = realloc(life->marks, capacity);
+    if (marks)
+      life->marks = marks;
+    if (!nodes || !marks) {
+      if (nodes)
+        life->nodes = nodes;
+      return NIL;
+    }
+
+    life->nodes = nodes;
+    life->capacity = capacity;
+    if (capacity > life->bucketMask + 1)
+      rehash(life, capacity);
+  }
+
+  return life->nodeCount++;
+}
+
+// Returns the canonical node with the given quadrants, creating it if needed
+static uint32_t join(HashLife *life, uint32_t nw, uint32_t ne, uint32_t sw,
+                     uint32_t se) {
+  uint32_t h = hashChildren(nw, ne, sw, se);
+
+  for (uint32_t i = life->buckets[h & life->bucketMask]; i != NIL;
+       i = life->nodes[i].next) {
+    const Node *node = &life->nodes[i];
+    if (node->child[NW] == nw && node->child[NE] == ne &&
+        node->child[SW] == sw && node->child[SE] == se)
+      return i;
+  }
+
+  uint32_t index = allocNode(life);
+  if (index == NIL)
+    abort(); // Out of memory: a step can't be abandoned half way
+
+  // The arena may have moved or been rehashed
+  Node *nodes = life->nodes;
+  Node *node = &nodes[index];
+  node->child[NW] = nw;
+  node->child[NE] = ne;
+  node->child[SW] = sw;
+  node->child[SE] = se;
+  node->level = nodes[nw].level + 1;
+  node->population =
+      addPopulation(addPopulation(nodes[nw].population, nodes[ne].population),
+                    addPopulation(nodes[sw].population, nodes[se].population));
+
+  uint32_t b = h & life->bucketMask;
+  node->next = life->buckets[b];
+  life->buckets[b] = index;
+  life->inUse++;
+
+  return index;
+}
+
+static uint32_t emptyNode(HashLife *life, int level) {
+  for (int i = 1; i <= level; i++) {
+    if (life->empty[i] == NIL) {
+      uint32_t e = life->empty[i - 1];
+      life->empty[i] = join(life, e, e, e, e);
+    }
+  }
+  return life->empty[level];
+}
+
+static inline uint32_t quad(const HashLife *life, uint32_t node, int q) {
+  return life->nodes[node].child[q];
+}
+
+// Level n - 1 node centered on a level n node
+static uint32_t centerOf(HashLife *life, uint32_t n) {
+  return join(life, quad(life, quad(life, n, NW), SE),
+              quad(life, quad(life, n, NE), SW),
+              quad(life, quad(life, n, SW), NE),
+              quad(life, quad(life, n, SE), NW));
+}
+
+// Level n node centered between two horizontally adjacent level n nodes
+static uint32_t centerHorizontal(HashLife *life, uint32_t w, uint32_t e) {
+  return join(life, quad(life, w, NE), quad(life, e, NW), quad(life, w, SE),
+              quad(life, e, SW));
+}
+
+// Level n node centered between two vertically adjacent level n nodes
+static uint32_t centerVertical(HashLife *life, uint32_t n, uint32_t s) {
+  return join(life, quad(life, n, SW), quad(life, n, SE), quad(life, s, NW),
+              quad(life, s, NE));
+}
+
+static uint32_t cacheLookup(HashLife *life, uint32_t node, int stepLog2) {
+  CacheSet *set = &life->cache[hashChildren(node, stepLog2, 0, 0) &
+                               life->cacheMask];
+
+  for (int way = 0; way < 2; way++) {
+    if (set->node[way] == node && set->stepLog2[way] == stepLog2) {
+      set->recent = way;
+      life->cacheHits++;
+      return set->result[way];
+    }
+  }
+
+  life->cacheMisses++;
+  return NIL;
+}
+
+static void cacheStore(HashLife *life, uint32_t node, int stepLog2,
+                       uint32_t result) {
+  CacheSet *set = &life->cache[hashChildren(node, stepLog2, 0, 0) &
+                               life->cacheMask];
+  int way = !set->recent;
+
+  if (set->node[way] != NIL)
+    life->cacheEvictions++;
+  set->node[way] = node;
+  set->result[way] = result;
+  set->stepLog2[way] = (uint8_t)stepLog2;
+  set->recent = way;
+}
+
+// Result of a level 2 node: its 2x2 center one generation later
+static uint32_t leafSuccessor(HashLife *life, uint32_t node) {
+  int bits = 0;
+
+  // Gather the 4x4 cells, bit (y * 4 + x)
+  for (int q = 0; q < 4; q++) {
+    uint32_t sub = quad(life, node, q);
+    int ox = (q & 1) * 2, oy = (q >> 1) * 2;
+    for (int c = 0; c < 4; c++) {
+      if (quad(life, sub, c) == ALIVE_CELL)
+        bits |= 1 << ((oy + (c >> 1)) * 4 + ox + (c & 1));
+    }
+  }
+
+  return life->leaves[life->leafResult[bits]];
+}
+
+// Center of a level n node, 2^stepLog2 generations later (stepLog2 <= n - 2)
+static uint32_t successor(HashLife *life, uint32_t node, int stepLog2) {
+  const Node *n = &life->nodes[node];
+  int level = n->level;
+
+  if (n->population == 0)
+    return emptyNode(life, level - 1);
+  if (level == 2)
+    return leafSuccessor(life, node);
+
+  uint32_t cached = cacheLookup(life, node, stepLog2);
+  if (cached != NIL)
+    return cached;
+
+  uint32_t nw = quad(life, node, NW), ne = quad(life, node, NE);
+  uint32_t sw = quad(life, node, SW), se = quad(life, node, SE);
+
+  // Nine overlapping level n - 1 subnodes covering the node
+  uint32_t s[9] = {
+      nw,
+      centerHorizontal(life, nw, ne),
+      ne,
+      centerVertical(life, nw, sw),
+      centerOf(life, node),
+      centerVertical(life, ne, se),
+      sw,
+      centerHorizontal(life, sw, se),
+      se,
+  };
+
+  // Full speed does the first half of the time in the nine subnodes, slower
+  // steps just take their centers and spend all the time in the second half
+  for (int i = 0; i < 9; i++)
+    s[i] = (stepLog2 == level - 2) ? successor(life, s[i], level - 3)
+                                   : centerOf(life, s[i]);
+
+  int second = (stepLog2 == level - 2) ? level - 3 : stepLog2;
+  uint32_t result = join(
+      life, successor(life, join(life, s[0], s[1], s[3], s[4]), second),
+      successor(life, join(life, s[1], s[2], s[4], s[5]), second),
+      successor(life, join(life, s[3], s[4], s[6], s[7]), second),
+      successor(life, join(life, s[4], s[5], s[7], s[8]), second));
+
+  cacheStore(life, node, stepLog2, result);
+  return result;
+}
+
+// The rule on the 4x4 leaf blocks, as a lookup table
+static void buildLeafTable(HashLife *life) {
+  for (int bits = 0; bits < (1 << 16); bits++) {
+    int result = 0;
+
+    for (int c = 0; c < 4; c++) {
+      int x = 1 + (c & 1), y = 1 + (c >> 1);
+      int neighbors = 0;
+      for (int dy = -1; dy <= 1; dy++)
+        for (int dx = -1; dx <= 1; dx++)
+          if (dx || dy)
+            neighbors += (bits >> ((y + dy) * 4 + x + dx)) & 1;
+
+      int alive = (bits >> (y * 4 + x)) & 1;
+      if (getRuleNextState(life->rule, alive, neighbors))
+        result |= 1 << c;
+    }
+
+    life->leafResult[bits] = (uint8_t)result;
+  }
+}
+
+static void clearCache(HashLife *life) {
+  for (uint32_t i = 0; i <= life->cacheMask; i++)
+    life->cache[i] = (CacheSet){{NIL, NIL}, {NIL, NIL}, {0, 0}, 0};
+}
+
+static void mark(HashLife *life, uint32_t node) {
+  if (node <= ALIVE_CELL || life->marks[node])
+    return;
+
+  life->marks[node] = 1;
+  for (int q = 0; q < 4; q++)
+    mark(life, quad(life, node, q));
+}
+
+// Frees every node not reachable from the root and clears the result cache,
+// which may refer to freed nodes
+static void collectGarbage(HashLife *life) {
+  memset(life->marks, 0, life->nodeCount);
+  mark(life, life->root);
+  for (int i = 1; i <= MAX_LEVEL; i++)
+    if (life->empty[i] != NIL)
+      mark(life, life->empty[i]);
+  for (int i = 0; i < 16; i++)
+    mark(life, life->leaves[i]);
+
+  life->freeList = NIL;
+  life->inUse = 0;
+  for (uint32_t i = life->nodeCount - 1; i > ALIVE_CELL; i--) {
+    if (life->marks[i]) {
+      life->inUse++;
+    } else {
+      life->nodes[i].level = 0;
+      life->nodes[i].next = life->freeList;
+      life->freeList = i;
+    }
+  }
+
+  rehash(life, life->bucketMask + 1);
+  clearCache(life);
+  life->collections++;
+}
+
+static inline int rootLevel(const HashLife *life) {
+  return life->nodes[life->root].level;
+}
+
+// Surrounds the root with empty space, keeping it centered on the origin
+static void expandRoot(HashLife *life) {
+  uint32_t root = life->root;
+  uint32_t e = emptyNode(life, rootLevel(life) - 1);
+
+  life->root = join(life,
+                    join(life, e, e, e, quad(life, root, NW)),
+                    join(life, e, e, quad(life, root, NE), e),
+                    join(life, e, quad(life, root, SW), e, e),
+                    join(life, quad(life, root, SE), e, e, e));
+}
+
+HashLife *createHashLife(size_t nodeBudget, size_t cacheEntries) {
+  HashLife *life = calloc(1, sizeof(HashLife));
+  if (!life)
+    return NULL;
+
+  uint32_t capacity = 1024;
+  while (capacity < nodeBudget && capacity < NIL / 4)
+    capacity *= 2;
+  uint32_t sets = 1;
+  while (sets * 2 < cacheEntries && sets < NIL / 4)
+    sets *= 2;
+
+  life->budget = capacity;
+  life->capacity = capacity;
+  life->nodes = malloc(capacity * sizeof(Node));
+  life->marks = malloc(capacity);
+  life->cache = malloc(sets * sizeof(CacheSet));
+  life->cacheMask = sets - 1;
+  if (!life->nodes || !life->marks || !life->cache) {
+    destroyHashLife(life);
+    return NULL;
+  }
+
+  life->nodes[DEAD_CELL] = (Node){{NIL, NIL, NIL, NIL}, NIL, 0, 0};
+  life->nodes[ALIVE_CELL] = (Node){{NIL, NIL, NIL, NIL}, NIL, 0, 1};
+  life->nodeCount = 2;
+  life->freeList = NIL;
+  life->bucketMask = 0;
+  rehash(life, capacity);
+  if (!life->buckets) {
+    destroyHashLife(life);
+    return NULL;
+  }
+  clearCache(life);
+
+  for (int i = 0; i <= MAX_LEVEL; i++)
+    life->empty[i] = NIL;
+  life->empty[0] = DEAD_CELL;
+  for (int i = 0; i < 16; i++)
+    life->leaves[i] = join(life, (i >> 0) & 1, (i >> 1) & 1, (i >> 2) & 1,
+                           (i >> 3) & 1);
+  life->rule = RULE_LIFE;
+  buildLeafTable(life);
+
+  life->root = emptyNode(life, 3);
+  return life;
+}
+
+int setHashLifeRule(HashLife *life, Rule rule) {
+  // Births on 0 neighbors would fill the empty plane
+  if (rule.birth & 1)
+    return 0;
+
+  if (!isSameRule(rule, life->rule)) {
+    life->rule = rule;
+    buildLeafTable(life);
+    clearCache(life);
+  }
+
+  return 1;
+}
+
+void destroyHashLife(HashLife *life) {
+  if (!life)
+    return;
+
+  free(life->nodes);
+  free(life->marks);
+  free(life->buckets);
+  free(life->cache);
+  free(life);
+}
+
+// Builds the node covering 2^level cells from plane cell (x, y), reading
+// cells from the board where the node overlaps it
+static uint32_t buildFromBoard(HashLife *life, const Board *board, int level,
+                               long long x, long long y) {
+  long long size = 1LL << level;
+
+  if (x >= board->cols || y >= board->rows || x + size <= 0 || y + size <= 0)
+    return emptyNode(life, level);
+  if (level == 0)
+    return getBoardCell(board, (int)x, (int)y) ? ALIVE_CELL : DEAD_CELL;
+
+  // Skip 64-cell aligned blocks with no alive words
+  if (level == 6 && x >= 0 && y >= 0) {
+    uint64_t any = 0;
+    for (long long i = y; i < y + size && i < board->rows; i++)
+      any |= boardRow(board, (int)i)[x >> 6];
+    if (!any)
+      return emptyNode(life, level);
+  }
+
+  long long half = size / 2;
+  uint32_t nw = buildFromBoard(life, board, level - 1, x, y);
+  uint32_t ne = buildFromBoard(life, board, level - 1, x + half, y);
+  uint32_t sw = buildFromBoard(life, board, level - 1, x, y + half);
+  uint32_t se = buildFromBoard(life, board, level - 1, x + half, y + half);
+  return join(life, nw, ne, sw, se);
+}
+
+void loadHashLifeFromBoard(HashLife *life, const Board *board) {
+  int level = 7;
+  int extent = (board->rows > board->cols) ? board->rows : board->cols;
+  while ((1LL << (level - 1)) < extent)
+    level++;
+
+  long long half = 1LL << (level - 1);
+  life->root = buildFromBoard(life, board, level, -half, -half);
+  collectGarbage(life);
+}
+
+static void storeNode(const HashLife *life, uint32_t node, Board *board,
+                      long long x, long long y) {
+  const Node *n = &life->nodes[node];
+  long long size = 1LL << n->level;
+
+  if (n->population == 0 || x >= board->cols || y >= board->rows ||
+      x + size <= 0 || y + size <= 0)
+    return;
+
+  if (n->level == 0) {
+    boardRow(board, (int)y)[x >> 6] |= 1ULL << (x & 63);
+    return;
+  }
+
+  long long half = size / 2;
+  storeNode(life, n->child[NW], board, x, y);
+  storeNode(life, n->child[NE], board, x + half, y);
+  storeNode(life, n->child[SW], board, x, y + half);
+  storeNode(life, n->child[SE], board, x + half, y + half);
+}
+
+void storeHashLifeToBoard(const HashLife *life, Board *board) {
+  long long half = 1LL << (rootLevel(life) - 1);
+
+  clearBoard(board);
+  storeNode(life, life->root, board, -half, -half);
+  refreshBoard(board);
+}
+
+// Rebuilds the path down to one cell, (x, y) relative to the node corner
+static uint32_t setCell(HashLife *life, uint32_t node, long long x,
+                        long long y, int alive) {
+  int level = life->nodes[node].level;
+  if (level == 0)
+    return alive ? ALIVE_CELL : DEAD_CELL;
+
+  long long half = 1LL << (level - 1);
+  int q = ((y >= half) << 1) | (x >= half);
+  uint32_t child[4];
+  for (int i = 0; i < 4; i++)
+    child[i] = quad(life, node, i);
+
+  child[q] = setCell(life, child[q], x - (q & 1) * half,
+                     y - (q >> 1) * half, alive);
+  return join(life, child[NW], child[NE], child[SW], child[SE]);
+}
+
+void setHashLifeCell(HashLife *life, long long x, long long y, int alive) {
+  for (;;) {
+    long long half = 1LL << (rootLevel(life) - 1);
+    if (x >= -half && x < half && y >= -half && y < half) {
+      life->root = setCell(life, life->root, x + half, y + half, alive);
+      return;
+    }
+    if (rootLevel(life) >= MAX_LEVEL - 1)
+      return;
+    expandRoot(life);
+  }
+}
+
+long long stepHashLife(HashLife *life, int stepLog2) {
+  if (stepLog2 < 0)
+    stepLog2 = 0;
+  if (stepLog2 > HASHLIFE_MAX_STEP_LOG2)
+    stepLog2 = HASHLIFE_MAX_STEP_LOG2;
+
+  if (life->inUse > (long long)life->budget * GC_THRESHOLD_NUM / GC_THRESHOLD_DEN)
+    collectGarbage(life);
+
+  // The pattern must sit inside the center quarter of the root, so that after
+  // moving at most 2^stepLog2 cells it still lies inside the result, which is
+  // the center half of the root
+  for (;;) {
+    uint32_t root = life->root;
+    int level = rootLevel(life);
+    if (level >= stepLog2 + 3 && level >= 3 &&
+        life->nodes[centerOf(life, centerOf(life, root))].population ==
+            life->nodes[root].population)
+      break;
+    if (level >= MAX_LEVEL - 1)
+      return getHashLifePopulation(life);
+    expandRoot(life);
+  }
+
+  life->root = successor(life, life->root, stepLog2);
+  return getHashLifePopulation(life);
+}
+
+long long getHashLifePopulation(const HashLife *life) {
+  uint64_t population = life->nodes[life->root].population;
+  return (population > INT64_MAX) ? INT64_MAX : (long long)population;
+}
+
+HashLifeStats getHashLifeStats(const HashLife *life) {
+  HashLifeStats stats = {0};
+
+  stats.nodes = life->inUse;
+  stats.nodeBudget = life->budget;
+  stats.nodeCapacity = life->capacity;
+  stats.cacheHits = life->cacheHits;
+  stats.cacheMisses = life->cacheMisses;
+  stats.cacheEvictions = life->cacheEvictions;
+  stats.collections = life->collections;
+
+  return stats;
+}
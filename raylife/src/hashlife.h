@@ -0,0 +1,67 @@
+/*******************************************************************************************
+ *
+ *   HashLife: memoized quadtree Game of Life engine
+ *
+ *   The universe is an unbounded plane stored as a quadtree of canonical
+ *   (hash-consed) nodes, so repeated regions in space and time are computed
+ *   only once. A step advances the whole plane by 2^k generations at once.
+ *
+ *   The board is a window onto the plane: board cell (x, y) is plane cell
+ *   (x, y). Unlike the board engine, the plane does not wrap around.
+ *
+ *******************************************************************************************/
+
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include <stddef.h>
+
+#include "board.h"
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define HASHLIFE_DEFAULT_NODES (1 << 21)        // ~64 MB of nodes
+#define HASHLIFE_DEFAULT_CACHE_ENTRIES (1 << 20) // ~16 MB of cached results
+#define HASHLIFE_MAX_STEP_LOG2 30
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct HashLife HashLife;
+
+typedef struct {
+  long long nodes;       // Nodes in use
+  long long nodeBudget;  // Nodes kept before collecting garbage
+  long long nodeCapacity; // Allocated nodes, can exceed the budget mid-step
+  long long cacheHits;
+  long long cacheMisses;
+  long long cacheEvictions;
+  int collections; // Garbage collections run so far
+} HashLifeStats;
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// The rule is Conway's Life. The node budget is a soft limit: steps collect
+// garbage beforehand once it is used, but grow the nodes past it if needed,
+// and abort if memory runs out half way.
+HashLife *createHashLife(size_t nodeBudget, size_t cacheEntries);
+void destroyHashLife(HashLife *life);
+// Rules with births on 0 neighbors can't be run on an unbounded plane and
+// return 0, keeping the previous rule
+int setHashLifeRule(HashLife *life, Rule rule);
+
+// Replaces the whole plane with the board contents
+void loadHashLifeFromBoard(HashLife *life, const Board *board);
+// Writes the plane cells that fall inside the board, clearing the rest
+void storeHashLifeToBoard(const HashLife *life, Board *board);
+
+void setHashLifeCell(HashLife *life, long long x, long long y, int alive);
+
+// Advances the plane by 2^stepLog2 generations and returns its population
+long long stepHashLife(HashLife *life, int stepLog2);
+long long getHashLifePopulation(const HashLife *life);
+HashLifeStats getHashLifeStats(const HashLife *life);
+
+#endif // HASHLIFE_H
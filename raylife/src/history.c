@@ -0,0 +1,276 @@
+#include "history.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// A keyframe holds the board's cells. A delta holds, for each tile the step
+// changed, the tile index, a mask of its changed rows and their XOR words.
+typedef struct {
+  long long generation;
+  uint64_t *data;
+  size_t words;
+  int keyframe;
+} HistoryRecord;
+
+struct History {
+  HistoryRecord *records; // Ring, oldest first. The oldest is a keyframe.
+  int capacity;
+  int first;
+  int count;
+  int keyframes;
+  size_t bytes;
+  size_t maxBytes;
+  int deltas;             // Since the latest keyframe
+  size_t deltaWords;      // Since the latest keyframe
+  unsigned edits;         // Board edits at the latest record
+  uint64_t *scratch;      // Delta being encoded
+  size_t scratchWords;
+};
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+static HistoryRecord *getRecord(const History *history, int i) {
+  return &history->records[(history->first + i) % history->capacity];
+}
+
+static size_t getRecordBytes(size_t words) {
+  return sizeof(HistoryRecord) + words * sizeof(uint64_t);
+}
+
+static void dropRecord(History *history, HistoryRecord *record) {
+  history->bytes -= getRecordBytes(record->words);
+  history->keyframes -= record->keyframe;
+  free(record->data);
+  history->count--;
+}
+
+// Deltas can't be replayed without the keyframe before them, so they go
+// along with it
+static void dropOldest(History *history) {
+  do {
+    dropRecord(history, getRecord(history, 0));
+    history->first = (history->first + 1) % history->capacity;
+  } while (history->count > 0 && !getRecord(history, 0)->keyframe);
+}
+
+History *createHistory(size_t maxBytes) {
+  History *history = calloc(1, sizeof(History));
+  if (!history)
+    return NULL;
+
+  history->capacity = 64;
+  history->records = malloc(history->capacity * sizeof(HistoryRecord));
+  if (!history->records) {
+    free(history);
+    return NULL;
+  }
+  history->maxBytes = maxBytes;
+
+  return history;
+}
+
+void destroyHistory(History *history) {
+  if (!history)
+    return;
+
+  clearHistory(history);
+  free(history->records);
+  free(history->scratch);
+  free(history);
+}
+
+void clearHistory(History *history) {
+  while (history->count > 0)
+    dropOldest(history);
+  history->first = 0;
+  history->deltas = 0;
+  history->deltaWords = 0;
+}
+
+int isHistoryCurrent(const History *history, const Board *board) {
+  return history->count > 0 && history->edits == board->edits;
+}
+
+// Encodes the last step into the scratch buffer and returns its size in
+// words, or SIZE_MAX if it doesn't fit. The back buffer holds the previous
+// cells of every changed tile.
+static size_t encodeDelta(History *history, const Board *board) {
+  size_t most = (size_t)board->activeCount * (2 + TILE_ROWS);
+  if (most > history->scratchWords) {
+    uint64_t *scratch = realloc(history->scratch, most * sizeof(uint64_t));
+    if (!scratch)
+      return SIZE_MAX;
+    history->scratch = scratch;
+    history->scratchWords = most;
+  }
+
+  uint64_t *out = history->scratch;
+  size_t n = 0;
+  for (int a = 0; a < board->activeCount; a++) {
+    int tile = board->activeTiles[a];
+    if (!board->tileChanged[tile])
+      continue;
+
+    int w = tile % board->tilesX;
+    int r0 = (tile / board->tilesX) * TILE_ROWS;
+    int r1 = (r0 + TILE_ROWS < board->rows) ? r0 + TILE_ROWS : board->rows;
+    size_t header = n;
+    uint64_t mask = 0;
+
+    out[n++] = (uint64_t)tile;
+    n++;
+    for (int i = r0; i < r1; i++) {
+      size_t k = (size_t)i * board->words + w;
+      uint64_t change = board->cells[k] ^ board->next[k];
+      if (change) {
+        mask |= 1ULL << (i - r0);
+        out[n++] = change;
+      }
+    }
+    out[header + 1] = mask;
+  }
+
+  return n;
+}
+
+static void applyDelta(Board *board, const HistoryRecord *record) {
+  const uint64_t *p = record->data, *end = record->data + record->words;
+
+  while (p < end) {
+    int tile = (int)*p++;
+    uint64_t mask = *p++;
+    int w = tile % board->tilesX;
+    int r0 = (tile / board->tilesX) * TILE_ROWS;
+
+    for (; mask; mask &= mask - 1)
+      boardRow(board, r0 + __builtin_ctzll(mask))[w] ^= *p++;
+  }
+}
+
+static int growRecords(History *history) {
+  int capacity = history->capacity * 2;
+  HistoryRecord *records = malloc(capacity * sizeof(HistoryRecord));
+  if (!records)
+    return 0;
+
+  for (int i = 0; i < history->count; i++)
+    records[i] = *getRecord(history, i);
+  free(history->records);
+  history->records = records;
+  history->capacity = capacity;
+  history->first = 0;
+
+  return 1;
+}
+
+void recordHistory(History *history, const Board *board, long long generation,
+                   int keyframe) {
+  size_t boardWords = (size_t)board->rows * board->words;
+  size_t words = 0;
+
+  // A keyframe when replaying the deltas since the last one would take
+  // longer than copying the board
+  if (!isHistoryCurrent(history, board) ||
+      history->deltas >= HISTORY_KEYFRAME_INTERVAL ||
+      history->deltaWords >= boardWords)
+    keyframe = 1;
+  if (!keyframe) {
+    words = encodeDelta(history, board);
+    if (words >= boardWords)
+      keyframe = 1;
+  }
+  if (keyframe)
+    words = boardWords;
+
+  history->edits = board->edits;
+  if (getRecordBytes(boardWords) > history->maxBytes) {
+    clearHistory(history);
+    return;
+  }
+
+  while (history->count > 0 &&
+         history->bytes + getRecordBytes(words) > history->maxBytes)
+    dropOldest(history);
+
+  if (history->count == history->capacity && !growRecords(history))
+    dropOldest(history);
+
+  // Everything before this delta was dropped, so it has nothing to apply to
+  if (!keyframe && history->count == 0) {
+    keyframe = 1;
+    words = boardWords;
+  }
+
+  uint64_t *data = malloc(words * sizeof(uint64_t));
+  if (!data) {
+    clearHistory(history);
+    return;
+  }
+  memcpy(data, keyframe ? board->cells : history->scratch,
+         words * sizeof(uint64_t));
+
+  HistoryRecord *record = getRecord(history, history->count);
+  record->generation = generation;
+  record->data = data;
+  record->words = words;
+  record->keyframe = keyframe;
+  history->count++;
+  history->keyframes += keyframe;
+  history->bytes += getRecordBytes(words);
+
+  if (keyframe) {
+    history->deltas = 0;
+    history->deltaWords = 0;
+  } else {
+    history->deltas++;
+    history->deltaWords += words;
+  }
+}
+
+long long restoreHistory(History *history, Board *board, long long generation) {
+  int k = history->count - 1;
+  while (k >= 0 && getRecord(history, k)->generation > generation)
+    k--;
+  if (k < 0)
+    return -1;
+
+  int key = k;
+  while (!getRecord(history, key)->keyframe)
+    key--;
+
+  const HistoryRecord *record = getRecord(history, key);
+  memcpy(board->cells, record->data, record->words * sizeof(uint64_t));
+  history->deltas = 0;
+  history->deltaWords = 0;
+  for (int i = key + 1; i <= k; i++) {
+    applyDelta(board, getRecord(history, i));
+    history->deltas++;
+    history->deltaWords += getRecord(history, i)->words;
+  }
+  refreshBoard(board);
+
+  // The restored generation becomes the latest
+  while (history->count - 1 > k)
+    dropRecord(history, getRecord(history, history->count - 1));
+  history->edits = board->edits;
+
+  return getRecord(history, k)->generation;
+}
+
+HistoryStats getHistoryStats(const History *history) {
+  HistoryStats stats = {0};
+
+  stats.records = history->count;
+  stats.keyframes = history->keyframes;
+  stats.oldestGeneration =
+      history->count > 0 ? getRecord(history, 0)->generation : -1;
+  stats.bytes = history->bytes;
+  stats.maxBytes = history->maxBytes;
+
+  return stats;
+}
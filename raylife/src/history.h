@@ -0,0 +1,65 @@
+/*******************************************************************************************
+ *
+ *   History: past generations of the board, for rewinding
+ *
+ *   Each step is recorded as the XOR of the tiles it changed, only their
+ *   changed rows, so a settled board costs a few bytes per generation
+ *   whatever its size. Every so often a keyframe copies the whole board:
+ *   once the deltas since the last one add up to a board's worth, after
+ *   HISTORY_KEYFRAME_INTERVAL deltas, or after the board was edited.
+ *
+ *   An earlier generation is rebuilt from the nearest keyframe before it,
+ *   replaying the deltas in between. Past the memory cap, the oldest
+ *   keyframe and its deltas are dropped.
+ *
+ *******************************************************************************************/
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+
+#include "board.h"
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define HISTORY_DEFAULT_BYTES (64 << 20)
+#define HISTORY_KEYFRAME_INTERVAL 256 // Most deltas replayed to rebuild one
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct History History;
+
+typedef struct {
+  int records;                // Generations that can be restored
+  int keyframes;
+  long long oldestGeneration; // -1 when empty
+  size_t bytes;
+  size_t maxBytes;
+} HistoryStats;
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// Returns NULL on allocation failure
+History *createHistory(size_t maxBytes);
+void destroyHistory(History *history);
+void clearHistory(History *history);
+// Returns 0 if nothing was recorded yet or the board was edited since, in
+// which case the board should be recorded as a keyframe before stepping it.
+// Steps are not tracked: every step must be recorded.
+int isHistoryCurrent(const History *history, const Board *board);
+// Records the board as the given generation. Call right after each step,
+// when the board's back buffer and changed tiles still describe the step,
+// or with keyframe set for a board in any other state.
+void recordHistory(History *history, const Board *board, long long generation,
+                   int keyframe);
+// Restores the board to the latest recorded generation up to the given one,
+// and forgets the later ones. Returns the restored generation, or -1 if
+// there is none.
+long long restoreHistory(History *history, Board *board, long long generation);
+HistoryStats getHistoryStats(const History *history);
+
+#endif // HISTORY_H
@@ -0,0 +1,333 @@
+#include "pattern.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define RLE_LINE_LENGTH 70 // Longest RLE data line written, as in most tools
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef enum { PATTERN_CELLS = 0, PATTERN_RLE } PatternFormat;
+
+// Write position of a pattern being loaded, wrapping around the board
+typedef struct {
+  Board *board;
+  int x;   // Column where rows start
+  int col; // Current cell
+  int row;
+  long long count; // Cells set so far
+} Cursor;
+
+// Buffered RLE output, breaking lines at RLE_LINE_LENGTH
+typedef struct {
+  FILE *file;
+  int lineLength;
+} RleWriter;
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+static PatternFormat getPatternFormat(const char *fileName) {
+  const char *extension = strrchr(fileName, '.');
+  return (extension && !strcasecmp(extension, ".rle")) ? PATTERN_RLE
+                                                        : PATTERN_CELLS;
+}
+
+static void setCursorCells(Cursor *cursor, int run) {
+  Board *board = cursor->board;
+
+  for (int i = 0; i < run; i++) {
+    boardRow(board, cursor->row)[cursor->col >> 6] |= 1ULL << (cursor->col & 63);
+    if (++cursor->col == board->cols)
+      cursor->col = 0;
+  }
+  cursor->count += run;
+}
+
+static void skipCursorCells(Cursor *cursor, int run) {
+  cursor->col = (int)((cursor->col + (long long)run) % cursor->board->cols);
+}
+
+static void nextCursorRows(Cursor *cursor, int run) {
+  cursor->row = (int)((cursor->row + (long long)run) % cursor->board->rows);
+  cursor->col = cursor->x;
+}
+
+static void skipLine(FILE *file) {
+  for (int c; (c = getc(file)) != EOF && c != '\n';)
+    ;
+}
+
+// Reads the "x = 3, y = 3, rule = B3/S23" header line, whose first character
+// has already been read. Missing values are left as they are.
+static void readRleHeader(FILE *file, int first, PatternInfo *info) {
+  char line[256];
+  int length = 0;
+
+  line[length++] = (char)first;
+  for (int c; (c = getc(file)) != EOF && c != '\n';)
+    if (length < (int)sizeof(line) - 1)
+      line[length++] = (char)c;
+  line[length] = '\0';
+
+  for (char *key = line; *key; key++) {
+    if (key > line && isalpha((unsigned char)key[-1]))
+      continue;
+    int isRule = !strncmp(key, "rule", 4);
+    if (*key != 'x' && *key != 'y' && !isRule)
+      continue;
+
+    char *value = key + (isRule ? 4 : 1);
+    while (*value == ' ' || *value == '\t')
+      value++;
+    if (*value != '=')
+      continue;
+    value++;
+
+    if (isRule) {
+      // Up to the end of the field, without bounded grid suffixes (":T...")
+      char text[RULE_STRING_SIZE + 8];
+      int n = 0;
+      while (*value == ' ' || *value == '\t')
+        value++;
+      while (value[n] && value[n] != ',' && value[n] != ':' &&
+             !isspace((unsigned char)value[n]) && n < (int)sizeof(text) - 1) {
+        text[n] = value[n];
+        n++;
+      }
+      text[n] = '\0';
+      info->hasRule = parseRule(text, &info->rule);
+    } else {
+      *(*key == 'x' ? &info->width : &info->height) = atoi(value);
+    }
+  }
+}
+
+// Streams an RLE file into the board, or only measures it when the cursor
+// is NULL. Returns 0 on a malformed file.
+static int readRle(FILE *file, Cursor *cursor, PatternInfo *info) {
+  int run = 0, lineStart = 1;
+
+  for (int c; (c = getc(file)) != EOF;) {
+    if (lineStart && c == '#') {
+      skipLine(file);
+      continue;
+    }
+    if (lineStart && c == 'x') {
+      readRleHeader(file, c, info);
+      if (!cursor)
+        return 1;
+      continue;
+    }
+    lineStart = (c == '\n');
+
+    if (isdigit(c)) {
+      run = run * 10 + (c - '0');
+      if (run > (1 << 30))
+        return 0;
+      continue;
+    }
+    if (isspace(c))
+      continue;
+    if (c == '!')
+      break;
+
+    if (!run)
+      run = 1;
+    if (cursor) {
+      if (c == '$')
+        nextCursorRows(cursor, run);
+      else if (c == 'b' || c == '.')
+        skipCursorCells(cursor, run);
+      else if (isalpha(c))
+        setCursorCells(cursor, run);
+      else
+        return 0;
+    }
+    run = 0;
+  }
+
+  return 1;
+}
+
+// Streams a plaintext file into the board, or only measures it when the
+// cursor is NULL
+static void readCells(FILE *file, Cursor *cursor, PatternInfo *info) {
+  int x = 0, y = 0, lineStart = 1, comment = 0;
+
+  for (int c; (c = getc(file)) != EOF;) {
+    if (c == '\n') {
+      if (!comment) {
+        y++;
+        if (cursor)
+          nextCursorRows(cursor, 1);
+      }
+      x = 0, lineStart = 1, comment = 0;
+      continue;
+    }
+    if (lineStart && c == '!')
+      comment = 1;
+    lineStart = 0;
+    if (comment || c == '\r')
+      continue;
+
+    x++;
+    if (c == 'O' || c == '*') {
+      if (x > info->width)
+        info->width = x;
+      if (y + 1 > info->height)
+        info->height = y + 1;
+      if (cursor)
+        setCursorCells(cursor, 1);
+    } else if (cursor) {
+      skipCursorCells(cursor, 1);
+    }
+  }
+}
+
+int getPatternInfo(const char *fileName, PatternInfo *info) {
+  FILE *file = fopen(fileName, "r");
+  if (!file)
+    return 0;
+
+  *info = (PatternInfo){0, 0, RULE_LIFE, 0};
+
+  // RLE sizes come from the header, without reading the cells
+  int valid = 1;
+  if (getPatternFormat(fileName) == PATTERN_RLE)
+    valid = readRle(file, NULL, info);
+  else
+    readCells(file, NULL, info);
+
+  fclose(file);
+  return valid;
+}
+
+long long loadPattern(Board *board, const char *fileName, int x, int y) {
+  FILE *file = fopen(fileName, "r");
+  if (!file)
+    return -1;
+
+  // Start inside the board so wrapping needs no modulo per cell
+  x %= board->cols;
+  y %= board->rows;
+  if (x < 0)
+    x += board->cols;
+  if (y < 0)
+    y += board->rows;
+
+  Cursor cursor = {board, x, x, y, 0};
+  PatternInfo info = {0, 0, RULE_LIFE, 0};
+  int valid = 1;
+
+  if (getPatternFormat(fileName) == PATTERN_RLE)
+    valid = readRle(file, &cursor, &info);
+  else
+    readCells(file, &cursor, &info);
+
+  fclose(file);
+  refreshBoard(board);
+
+  return valid ? cursor.count : -1;
+}
+
+static void writeRleRun(RleWriter *writer, int run, char tag) {
+  char token[16];
+  int length = (run > 1) ? snprintf(token, sizeof(token), "%d%c", run, tag)
+                         : snprintf(token, sizeof(token), "%c", tag);
+
+  if (writer->lineLength + length > RLE_LINE_LENGTH) {
+    putc('\n', writer->file);
+    writer->lineLength = 0;
+  }
+  fputs(token, writer->file);
+  writer->lineLength += length;
+}
+
+// Column of the first cell at or after `from` in the given state, or the
+// board width if there is none. Whole words are skipped at a time.
+static int findCell(const Board *board, const uint64_t *row, int from,
+                    int alive) {
+  for (int w = from >> 6; w < board->words; w++) {
+    uint64_t bits = alive ? row[w] : ~row[w];
+    if (w == from >> 6)
+      bits &= ~0ULL << (from & 63);
+    if (bits) {
+      int col = w * 64 + __builtin_ctzll(bits);
+      return (col < board->cols) ? col : board->cols;
+    }
+  }
+
+  return board->cols;
+}
+
+static void exportRle(const Board *board, FILE *file) {
+  RleWriter writer = {file, 0};
+  int pendingRows = 0; // Row ends not written yet, trailing ones never are
+  char rule[RULE_STRING_SIZE];
+
+  formatRule(board->rule, rule, sizeof(rule));
+  fprintf(file, "#C Exported by raylife\n");
+  fprintf(file, "x = %d, y = %d, rule = %s\n", board->cols, board->rows, rule);
+
+  for (int i = 0; i < board->rows; i++) {
+    const uint64_t *row = boardRow(board, i);
+    int col = 0;
+
+    for (int start = findCell(board, row, 0, 1); start < board->cols;
+         start = findCell(board, row, col, 1)) {
+      int end = findCell(board, row, start, 0);
+
+      if (pendingRows) {
+        writeRleRun(&writer, pendingRows, '$');
+        pendingRows = 0;
+      }
+      if (start > col)
+        writeRleRun(&writer, start - col, 'b');
+      writeRleRun(&writer, end - start, 'o');
+      col = end;
+    }
+
+    pendingRows++;
+  }
+
+  writeRleRun(&writer, 1, '!');
+  putc('\n', file);
+}
+
+static void exportCells(const Board *board, FILE *file) {
+  fprintf(file, "!Name: raylife export\n");
+
+  for (int i = 0; i < board->rows; i++) {
+    const uint64_t *row = boardRow(board, i);
+    int last = -1;
+
+    // Trailing dead cells are left out
+    for (int w = board->words - 1; w >= 0 && last < 0; w--)
+      if (row[w])
+        last = w * 64 + 63 - __builtin_clzll(row[w]);
+    for (int j = 0; j <= last; j++)
+      putc(((row[j >> 6] >> (j & 63)) & 1) ? 'O' : '.', file);
+    putc('\n', file);
+  }
+}
+
+int exportPattern(const Board *board, const char *fileName) {
+  FILE *file = fopen(fileName, "w");
+  if (!file)
+    return 0;
+
+  if (getPatternFormat(fileName) == PATTERN_RLE)
+    exportRle(board, file);
+  else
+    exportCells(board, file);
+
+  return !ferror(file) & !fclose(file);
+}
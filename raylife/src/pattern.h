@@ -0,0 +1,49 @@
+/*******************************************************************************************
+ *
+ *   Pattern: Game of Life pattern files
+ *
+ *   Two formats are supported, chosen by file extension:
+ *   - .rle: run length encoded, the standard Life format. '#' lines are
+ *     comments, an optional "x = ..., y = ..., rule = ..." header gives the
+ *     size and rule, then runs of 'b' (dead) and 'o' (alive) cells follow.
+ *     '$' ends a row and '!' ends the pattern. Any other letter is an alive
+ *     cell of a multi-state rule.
+ *   - .cells (or anything else): plaintext, lines starting with '!' are
+ *     comments, 'O' (or '*') is an alive cell and any other character a dead
+ *     one.
+ *
+ *   Files are read and written as streams through the stdio buffer, so their
+ *   size is not limited by memory.
+ *
+ *******************************************************************************************/
+
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include "board.h"
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct {
+  int width;
+  int height;
+  Rule rule;   // Conway's Life unless the file gives one
+  int hasRule; // Only RLE files can
+} PatternInfo;
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// Reads the size (bounding box) and rule of a pattern file. Returns 0 if it
+// can't be read.
+int getPatternInfo(const char *fileName, PatternInfo *info);
+// Sets the pattern's alive cells with its top-left corner at (x, y), wrapping
+// around the board edges, then refreshes the board. Cells already alive are
+// kept. Returns the number of cells set, or -1 if the file can't be read.
+long long loadPattern(Board *board, const char *fileName, int x, int y);
+// Writes the whole board, so loading it at (0, 0) restores every cell in
+// place. Returns 0 if the file can't be written.
+int exportPattern(const Board *board, const char *fileName);
+
+#endif // PATTERN_H
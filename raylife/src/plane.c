@@ -0,0 +1,600 @@
+#include "plane.h"
+#include "cellkernel.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define TASK_CHUNKS 8            // Active chunks per thread pool task
+#define PARALLEL_MIN_CHUNKS 256  // Less active chunks are stepped on one thread
+#define MAP_MIN_CAPACITY 1024
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef enum {
+  DIR_N = 0,
+  DIR_NE,
+  DIR_E,
+  DIR_SE,
+  DIR_S,
+  DIR_SW,
+  DIR_W,
+  DIR_NW,
+} Direction; // The opposite of d is (d + 4) & 7
+
+typedef struct Chunk Chunk;
+
+struct Chunk {
+  long long x, y;                // Chunk coordinates, in CHUNK_SIZE cells
+  uint64_t cells[2][CHUNK_SIZE]; // Front and back buffers, by plane->front
+  Chunk *neighbors[8];           // By direction, NULL if not allocated
+  Chunk *nextFree;               // Pool free list
+  int index;                     // Position in plane->chunks
+  int population;
+  uint8_t edges;   // Directions whose edge of the chunk has alive cells
+  uint8_t changed; // Changed in the last step or was edited
+  uint8_t needed;  // A neighbor has alive cells on the shared edge
+  uint8_t active;  // Stepped in this generation
+};
+
+typedef struct ChunkSlab {
+  struct ChunkSlab *next;
+  Chunk chunks[CHUNK_SLAB_SIZE];
+} ChunkSlab;
+
+typedef struct {
+  _Alignas(64) long long value;
+  long long births;
+} PlaneSum;
+
+struct Plane {
+  Chunk **map;       // Open addressing by chunk coordinates
+  int mapMask;       // Capacity - 1
+  Chunk **chunks;    // Chunks in use, in no particular order
+  Chunk **active;    // Chunks stepped in this generation
+  int chunkCount;
+  int chunkCapacity; // Of chunks and active
+  int activeCount;
+  ChunkSlab *slabs;
+  int slabCount;
+  Chunk *freeChunks;
+  int front;         // Buffer holding the current generation
+  long long population;
+  long long births;  // In the last step, -1 unless counted
+  int countBirths;
+  Rule rule;
+  RuleKernel ruleKernel;
+  uint64_t ruleTable[32];
+  PlaneSum *workerAlive; // Per-thread population deltas of the running step
+  int workerCount;
+};
+
+typedef int (*StepChunkFunc)(Plane *plane, Chunk *chunk, int *births);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+static const int directionX[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const int directionY[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+static const uint64_t emptyRows[CHUNK_SIZE] = {0};
+
+static int getChunkSlot(const Plane *plane, long long x, long long y) {
+  uint64_t hash = (uint64_t)x * 0x9E3779B97F4A7C15ULL +
+                  (uint64_t)y * 0xC2B2AE3D27D4EB4FULL;
+  hash ^= hash >> 32;
+  hash *= 0xBF58476D1CE4E5B9ULL;
+  return (int)(hash >> 40) & plane->mapMask;
+}
+
+static Chunk *findChunk(const Plane *plane, long long x, long long y) {
+  for (int slot = getChunkSlot(plane, x, y);;
+       slot = (slot + 1) & plane->mapMask) {
+    Chunk *chunk = plane->map[slot];
+    if (!chunk || (chunk->x == x && chunk->y == y))
+      return chunk;
+  }
+}
+
+static void insertChunk(Plane *plane, Chunk *chunk) {
+  int slot = getChunkSlot(plane, chunk->x, chunk->y);
+  while (plane->map[slot])
+    slot = (slot + 1) & plane->mapMask;
+  plane->map[slot] = chunk;
+}
+
+// Backward shift deletion: later chunks of the probe run move up into the
+// hole, so lookups never need tombstones
+static void removeChunk(Plane *plane, Chunk *chunk) {
+  int hole = getChunkSlot(plane, chunk->x, chunk->y);
+  while (plane->map[hole] != chunk)
+    hole = (hole + 1) & plane->mapMask;
+  plane->map[hole] = NULL;
+
+  for (int slot = (hole + 1) & plane->mapMask; plane->map[slot];
+       slot = (slot + 1) & plane->mapMask) {
+    int home = getChunkSlot(plane, plane->map[slot]->x, plane->map[slot]->y);
+    // The chunk can move if its home is not cyclically in (hole, slot]
+    int stays = (hole <= slot) ? (home > hole && home <= slot)
+                               : (home > hole || home <= slot);
+    if (!stays) {
+      plane->map[hole] = plane->map[slot];
+      plane->map[slot] = NULL;
+      hole = slot;
+    }
+  }
+}
+
+// Grows the map and chunk lists so one more chunk fits
+static int reserveChunk(Plane *plane) {
+  if (plane->chunkCount == plane->chunkCapacity) {
+    int capacity = plane->chunkCapacity ? plane->chunkCapacity * 2 : 256;
+    Chunk **chunks = realloc(plane->chunks, capacity * sizeof(Chunk *));
+    if (!chunks)
+      return 0;
+    plane->chunks = chunks;
+    Chunk **active = realloc(plane->active, capacity * sizeof(Chunk *));
+    if (!active)
+      return 0;
+    plane->active = active;
+    plane->chunkCapacity = capacity;
+  }
+
+  // Kept at most half full, for short probes
+  if ((plane->chunkCount + 1) * 2 > plane->mapMask + 1) {
+    int capacity = (plane->mapMask + 1) * 2;
+    Chunk **map = calloc(capacity, sizeof(Chunk *));
+    if (!map)
+      return 0;
+    free(plane->map);
+    plane->map = map;
+    plane->mapMask = capacity - 1;
+    for (int i = 0; i < plane->chunkCount; i++)
+      insertChunk(plane, plane->chunks[i]);
+  }
+
+  return 1;
+}
+
+// Takes an empty chunk from the pool, adding a slab when it runs out
+static Chunk *allocChunk(Plane *plane, long long x, long long y) {
+  if (!reserveChunk(plane))
+    return NULL;
+
+  if (!plane->freeChunks) {
+    ChunkSlab *slab = malloc(sizeof(ChunkSlab));
+    if (!slab)
+      return NULL;
+    slab->next = plane->slabs;
+    plane->slabs = slab;
+    plane->slabCount++;
+    for (int i = CHUNK_SLAB_SIZE - 1; i >= 0; i--) {
+      slab->chunks[i].nextFree = plane->freeChunks;
+      plane->freeChunks = &slab->chunks[i];
+    }
+  }
+
+  Chunk *chunk = plane->freeChunks;
+  plane->freeChunks = chunk->nextFree;
+  memset(chunk, 0, sizeof(Chunk));
+  chunk->x = x;
+  chunk->y = y;
+  chunk->index = plane->chunkCount;
+  plane->chunks[plane->chunkCount++] = chunk;
+  insertChunk(plane, chunk);
+
+  for (int d = 0; d < 8; d++) {
+    Chunk *neighbor = findChunk(plane, x + directionX[d], y + directionY[d]);
+    chunk->neighbors[d] = neighbor;
+    if (neighbor)
+      neighbor->neighbors[(d + 4) & 7] = chunk;
+  }
+
+  return chunk;
+}
+
+static void freeChunk(Plane *plane, Chunk *chunk) {
+  for (int d = 0; d < 8; d++)
+    if (chunk->neighbors[d])
+      chunk->neighbors[d]->neighbors[(d + 4) & 7] = NULL;
+
+  removeChunk(plane, chunk);
+  Chunk *last = plane->chunks[--plane->chunkCount];
+  plane->chunks[chunk->index] = last;
+  last->index = chunk->index;
+
+  chunk->nextFree = plane->freeChunks;
+  plane->freeChunks = chunk;
+}
+
+// Directions whose edge has alive cells, from the top and bottom rows and
+// all rows ORed together
+static uint8_t getEdges(uint64_t top, uint64_t bottom, uint64_t columns) {
+  return (top != 0) << DIR_N | (bottom != 0) << DIR_S |
+         (columns & 1) << DIR_W | (columns >> 63) << DIR_E |
+         (top & 1) << DIR_NW | (top >> 63) << DIR_NE |
+         (bottom & 1) << DIR_SW | (bottom >> 63) << DIR_SE;
+}
+
+static uint8_t getChunkEdges(const uint64_t *rows) {
+  uint64_t columns = 0;
+  for (int i = 0; i < CHUNK_SIZE; i++)
+    columns |= rows[i];
+
+  return getEdges(rows[0], rows[CHUNK_SIZE - 1], columns);
+}
+
+Plane *createPlane(void) {
+  Plane *plane = calloc(1, sizeof(Plane));
+  if (!plane)
+    return NULL;
+
+  plane->map = calloc(MAP_MIN_CAPACITY, sizeof(Chunk *));
+  plane->mapMask = MAP_MIN_CAPACITY - 1;
+  plane->workerAlive = aligned_alloc(64, sizeof(PlaneSum));
+  plane->workerCount = 1;
+  if (!plane->map || !plane->workerAlive) {
+    destroyPlane(plane);
+    return NULL;
+  }
+
+  setPlaneRule(plane, RULE_LIFE);
+  return plane;
+}
+
+void destroyPlane(Plane *plane) {
+  if (!plane)
+    return;
+
+  while (plane->slabs) {
+    ChunkSlab *slab = plane->slabs;
+    plane->slabs = slab->next;
+    free(slab);
+  }
+  free(plane->map);
+  free(plane->chunks);
+  free(plane->active);
+  free(plane->workerAlive);
+  free(plane);
+}
+
+void clearPlane(Plane *plane) {
+  for (int i = 0; i < plane->chunkCount; i++) {
+    plane->chunks[i]->nextFree = plane->freeChunks;
+    plane->freeChunks = plane->chunks[i];
+  }
+
+  memset(plane->map, 0, (plane->mapMask + 1) * sizeof(Chunk *));
+  plane->chunkCount = 0;
+  plane->activeCount = 0;
+  plane->population = 0;
+}
+
+int setPlaneRule(Plane *plane, Rule rule) {
+  if (rule.birth & 1)
+    return 0;
+
+  plane->rule = rule;
+  plane->ruleKernel = getRuleKernel(rule);
+  fillRuleTable(rule, plane->ruleTable);
+
+  // Stable chunks may not be stable under the new rule
+  for (int i = 0; i < plane->chunkCount; i++)
+    plane->chunks[i]->changed = 1;
+
+  return 1;
+}
+
+void loadPlaneFromBoard(Plane *plane, const Board *board, long long x,
+                        long long y) {
+  long long x0 = x / CHUNK_SIZE, y0 = y / CHUNK_SIZE;
+  int chunkRows = (board->rows + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  for (int i = 0; i < board->rows; i++) {
+    const uint64_t *row = boardRow(board, i);
+    for (int w = 0; w < board->words; w++) {
+      long long cx = x0 + w, cy = y0 + i / CHUNK_SIZE;
+      Chunk *chunk = findChunk(plane, cx, cy);
+      if (!chunk && (!row[w] || !(chunk = allocChunk(plane, cx, cy))))
+        continue;
+
+      // The last word of a row only covers part of the chunk
+      uint64_t mask = (w == board->words - 1) ? board->lastWordMask : ~0ULL;
+      uint64_t *cells = &chunk->cells[plane->front][i % CHUNK_SIZE];
+      int alive =
+          __builtin_popcountll(row[w]) - __builtin_popcountll(*cells & mask);
+      *cells = (*cells & ~mask) | row[w];
+      chunk->population += alive;
+      plane->population += alive;
+    }
+  }
+
+  for (int cy = 0; cy < chunkRows; cy++) {
+    for (int w = 0; w < board->words; w++) {
+      Chunk *chunk = findChunk(plane, x0 + w, y0 + cy);
+      if (chunk) {
+        chunk->edges = getChunkEdges(chunk->cells[plane->front]);
+        chunk->changed = 1;
+      }
+    }
+  }
+}
+
+void storePlaneToBoard(const Plane *plane, Board *board, long long x,
+                       long long y) {
+  long long x0 = x / CHUNK_SIZE, y0 = y / CHUNK_SIZE;
+
+  memset(board->cells, 0, (size_t)board->rows * board->words * sizeof(uint64_t));
+  for (int i = 0; i < plane->chunkCount; i++) {
+    const Chunk *chunk = plane->chunks[i];
+    long long w = chunk->x - x0;
+    long long r0 = (chunk->y - y0) * CHUNK_SIZE;
+    if (w < 0 || w >= board->words || r0 <= -CHUNK_SIZE || r0 >= board->rows)
+      continue;
+
+    uint64_t mask = (w == board->words - 1) ? board->lastWordMask : ~0ULL;
+    for (int r = 0; r < CHUNK_SIZE; r++)
+      if (r0 + r >= 0 && r0 + r < board->rows)
+        boardRow(board, (int)(r0 + r))[w] =
+            chunk->cells[plane->front][r] & mask;
+  }
+
+  refreshBoard(board);
+}
+
+void setPlaneCell(Plane *plane, long long x, long long y, int alive) {
+  // Arithmetic shifts round down for negative coordinates too
+  long long cx = x >> 6, cy = y >> 6; // CHUNK_SIZE is 64
+  Chunk *chunk = findChunk(plane, cx, cy);
+  if (!chunk && (!alive || !(chunk = allocChunk(plane, cx, cy))))
+    return;
+
+  uint64_t *row = &chunk->cells[plane->front][y & (CHUNK_SIZE - 1)];
+  uint64_t bit = 1ULL << (x & (CHUNK_SIZE - 1));
+  if (!(*row & bit) == !alive)
+    return;
+
+  *row ^= bit;
+  chunk->population += alive ? 1 : -1;
+  plane->population += alive ? 1 : -1;
+  chunk->edges = getChunkEdges(chunk->cells[plane->front]);
+  chunk->changed = 1;
+}
+
+int getPlaneCell(const Plane *plane, long long x, long long y) {
+  const Chunk *chunk = findChunk(plane, x >> 6, y >> 6);
+  if (!chunk)
+    return 0;
+
+  return (chunk->cells[plane->front][y & (CHUNK_SIZE - 1)] >>
+          (x & (CHUNK_SIZE - 1))) &
+         1;
+}
+
+static const uint64_t *getNeighborRows(const Plane *plane, const Chunk *chunk,
+                                       Direction d) {
+  return chunk->neighbors[d] ? chunk->neighbors[d]->cells[plane->front]
+                             : emptyRows;
+}
+
+// Steps one chunk into its back buffer. The rows above and below come from
+// the north and south neighbors, and the bits beyond each side from the
+// west and east ones. Returns the population change of the chunk, and adds
+// the cells born to *births unless it is NULL.
+static inline __attribute__((always_inline)) int
+stepChunkKernel(Plane *plane, Chunk *chunk, int *births, RuleKernel kernel) {
+  const uint64_t *cells = chunk->cells[plane->front];
+  uint64_t *next = chunk->cells[plane->front ^ 1];
+  const uint64_t *north = getNeighborRows(plane, chunk, DIR_N);
+  const uint64_t *south = getNeighborRows(plane, chunk, DIR_S);
+  const uint64_t *west = getNeighborRows(plane, chunk, DIR_W);
+  const uint64_t *east = getNeighborRows(plane, chunk, DIR_E);
+  const uint64_t *northWest = getNeighborRows(plane, chunk, DIR_NW);
+  const uint64_t *northEast = getNeighborRows(plane, chunk, DIR_NE);
+  const uint64_t *southWest = getNeighborRows(plane, chunk, DIR_SW);
+  const uint64_t *southEast = getNeighborRows(plane, chunk, DIR_SE);
+  int last = CHUNK_SIZE - 1;
+  uint64_t changed = 0, columns = 0;
+  uint64_t aliveLanes = 0, bornLanes = 0;
+  int countBirths = (births != NULL);
+  uint64_t a0, a1, m0, m1, b0, b1;
+
+  sumRow(north[last], northWest[last] >> 63, northEast[last] << 63, &a0, &a1,
+         &m0, &m1);
+  sumRow(cells[0], west[0] >> 63, east[0] << 63, &b0, &b1, &m0, &m1);
+
+  for (int i = 0; i < CHUNK_SIZE; i++) {
+    uint64_t c0 = b0, c1 = b1, cm0 = m0, cm1 = m1;
+    if (i < last)
+      sumRow(cells[i + 1], west[i + 1] >> 63, east[i + 1] << 63, &b0, &b1, &m0,
+             &m1);
+    else
+      sumRow(south[0], southWest[0] >> 63, southEast[0] << 63, &b0, &b1, &m0,
+             &m1);
+
+    uint64_t self = cells[i];
+    uint64_t cell = nextCells(kernel, plane->ruleTable, self, a0, a1, cm0, cm1,
+                              b0, b1);
+    next[i] = cell;
+    changed |= cell ^ self;
+    columns |= cell;
+    aliveLanes += countLanes(cell);
+    if (countBirths)
+      bornLanes += countLanes(cell & ~self);
+
+    a0 = c0;
+    a1 = c1;
+  }
+
+  chunk->edges = getEdges(next[0], next[last], columns);
+  chunk->changed = (changed != 0);
+
+  int alive = sumLanes(aliveLanes);
+  int delta = alive - chunk->population;
+  chunk->population = alive;
+  if (countBirths)
+    *births += sumLanes(bornLanes);
+  return delta;
+}
+
+static int stepChunkLife(Plane *plane, Chunk *chunk, int *births) {
+  return stepChunkKernel(plane, chunk, births, KERNEL_LIFE);
+}
+
+static int stepChunkHighLife(Plane *plane, Chunk *chunk, int *births) {
+  return stepChunkKernel(plane, chunk, births, KERNEL_HIGHLIFE);
+}
+
+static int stepChunkDayAndNight(Plane *plane, Chunk *chunk, int *births) {
+  return stepChunkKernel(plane, chunk, births, KERNEL_DAY_AND_NIGHT);
+}
+
+static int stepChunkTable(Plane *plane, Chunk *chunk, int *births) {
+  return stepChunkKernel(plane, chunk, births, KERNEL_TABLE);
+}
+
+static const StepChunkFunc stepChunkKernels[] = {
+    stepChunkLife, stepChunkHighLife, stepChunkDayAndNight, stepChunkTable};
+
+static void stepTask(void *ctx, int task, int worker) {
+  Plane *plane = ctx;
+  int begin = task * TASK_CHUNKS;
+  int end = (begin + TASK_CHUNKS < plane->activeCount) ? begin + TASK_CHUNKS
+                                                       : plane->activeCount;
+  StepChunkFunc stepChunk = stepChunkKernels[plane->ruleKernel];
+  long long delta = 0;
+  int births = 0;
+
+  for (int i = begin; i < end; i++)
+    delta += stepChunk(plane, plane->active[i],
+                       plane->countBirths ? &births : NULL);
+
+  plane->workerAlive[worker].value += delta;
+  plane->workerAlive[worker].births += births;
+}
+
+// Alive cells on a chunk edge may spread into the neighbor across it, which
+// is allocated if missing. New chunks are marked as changed, so they get
+// stepped along with their neighbors.
+static void growChunks(Plane *plane) {
+  int count = plane->chunkCount;
+
+  for (int i = 0; i < count; i++)
+    plane->chunks[i]->needed = 0;
+
+  for (int i = 0; i < count; i++) {
+    Chunk *chunk = plane->chunks[i];
+    for (int d = 0; d < 8; d++) {
+      if (!(chunk->edges >> d & 1))
+        continue;
+
+      Chunk *neighbor = chunk->neighbors[d];
+      if (!neighbor) {
+        neighbor = allocChunk(plane, chunk->x + directionX[d],
+                              chunk->y + directionY[d]);
+        if (!neighbor)
+          continue;
+        neighbor->changed = 1;
+      }
+      neighbor->needed = 1;
+    }
+  }
+}
+
+// A chunk is stepped if it or one of its neighbors changed. The others keep
+// their cells, and since they did not change in the last step either, the
+// back buffer already holds those cells.
+static void collectActiveChunks(Plane *plane) {
+  plane->activeCount = 0;
+  for (int i = 0; i < plane->chunkCount; i++) {
+    Chunk *chunk = plane->chunks[i];
+    int active = chunk->changed;
+    for (int d = 0; d < 8 && !active; d++)
+      active = chunk->neighbors[d] && chunk->neighbors[d]->changed;
+
+    chunk->active = (uint8_t)active;
+    if (active)
+      plane->active[plane->activeCount++] = chunk;
+  }
+
+  // Chunks that are not stepped will not change in this generation
+  for (int i = 0; i < plane->chunkCount; i++)
+    if (!plane->chunks[i]->active)
+      plane->chunks[i]->changed = 0;
+}
+
+// Empty chunks go back to the pool once both buffers are clear and no
+// neighbor can spread cells into them
+static void freeDeadChunks(Plane *plane) {
+  for (int i = plane->chunkCount - 1; i >= 0; i--) {
+    Chunk *chunk = plane->chunks[i];
+    if (chunk->population == 0 && !chunk->changed && !chunk->needed)
+      freeChunk(plane, chunk);
+  }
+}
+
+long long stepPlane(Plane *plane, ThreadPool *pool) {
+  int threads = getThreadPoolSize(pool);
+
+  growChunks(plane);
+  collectActiveChunks(plane);
+
+  // A few active chunks step faster than the pool can wake up
+  if (plane->activeCount < PARALLEL_MIN_CHUNKS)
+    pool = NULL, threads = 1;
+
+  if (threads > plane->workerCount) {
+    PlaneSum *sums = aligned_alloc(64, threads * sizeof(PlaneSum));
+    if (sums) {
+      free(plane->workerAlive);
+      plane->workerAlive = sums;
+      plane->workerCount = threads;
+    } else {
+      pool = NULL, threads = 1;
+    }
+  }
+
+  for (int i = 0; i < threads; i++) {
+    plane->workerAlive[i].value = 0;
+    plane->workerAlive[i].births = 0;
+  }
+
+  int tasks = (plane->activeCount + TASK_CHUNKS - 1) / TASK_CHUNKS;
+  runThreadPool(pool, tasks, stepTask, plane);
+
+  plane->births = plane->countBirths ? 0 : -1;
+  for (int i = 0; i < threads; i++) {
+    plane->population += plane->workerAlive[i].value;
+    if (plane->countBirths)
+      plane->births += plane->workerAlive[i].births;
+  }
+
+  plane->front ^= 1;
+  freeDeadChunks(plane);
+
+  return plane->population;
+}
+
+void setPlaneBirthCounting(Plane *plane, int count) {
+  plane->countBirths = count;
+}
+
+long long getPlanePopulation(const Plane *plane) {
+  return plane->population;
+}
+
+PlaneStats getPlaneStats(const Plane *plane) {
+  PlaneStats stats = {0};
+
+  stats.chunks = plane->chunkCount;
+  stats.pooledChunks = plane->slabCount * CHUNK_SLAB_SIZE;
+  stats.activeChunks = plane->activeCount;
+  stats.births = plane->births;
+  stats.bytes = plane->slabCount * sizeof(ChunkSlab) +
+                (plane->mapMask + 1) * sizeof(Chunk *) +
+                2 * plane->chunkCapacity * sizeof(Chunk *);
+
+  return stats;
+}
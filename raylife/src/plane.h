@@ -0,0 +1,81 @@
+/*******************************************************************************************
+ *
+ *   Plane: unbounded sparse Game of Life board
+ *
+ *   The plane is split into chunks of 64x64 cells, one word per row like the
+ *   board's tiles, kept in a hash map by chunk coordinates. A chunk is only
+ *   allocated once cells on a neighbor's edge may spread into it, and freed
+ *   once it is empty and no neighbor needs it, so memory and stepping time
+ *   follow the live cells wherever they go. Chunks come from a pool of
+ *   slabs, reused without going back to malloc.
+ *
+ *   Like the board, only chunks that changed, or next to one that did, are
+ *   stepped. Cell coordinates are 64-bit and do not wrap around.
+ *
+ *   The board is a window onto the plane: board cell (x, y) is plane cell
+ *   (x0 + x, y0 + y) for the window origin (x0, y0).
+ *
+ *******************************************************************************************/
+
+#ifndef PLANE_H
+#define PLANE_H
+
+#include <stddef.h>
+
+#include "board.h"
+#include "threadpool.h"
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define CHUNK_SIZE 64        // Cells per chunk side
+#define CHUNK_SLAB_SIZE 256  // Chunks allocated at once by the pool
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct Plane Plane;
+
+typedef struct {
+  int chunks;         // Chunks in use
+  int pooledChunks;   // Chunks allocated, used or free in the pool
+  int activeChunks;   // Chunks stepped in the last generation
+  long long births;   // Cells born in the last generation, -1 if not counted
+  size_t bytes;       // Chunk slabs and hash map
+} PlaneStats;
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// Returns NULL on allocation failure. The rule is Conway's Life.
+Plane *createPlane(void);
+void destroyPlane(Plane *plane);
+// Frees every chunk, keeping them in the pool
+void clearPlane(Plane *plane);
+// Rules with births on 0 neighbors can't be run on an unbounded plane and
+// return 0, keeping the previous rule
+int setPlaneRule(Plane *plane, Rule rule);
+
+// Replaces the plane cells inside the window at (x, y) with the board's,
+// leaving the rest of the plane as it was. The origin must be a multiple of
+// CHUNK_SIZE.
+void loadPlaneFromBoard(Plane *plane, const Board *board, long long x,
+                        long long y);
+// Writes the plane cells that fall inside the window at (x, y), clearing the
+// rest of the board. The origin must be a multiple of CHUNK_SIZE.
+void storePlaneToBoard(const Plane *plane, Board *board, long long x,
+                       long long y);
+
+void setPlaneCell(Plane *plane, long long x, long long y, int alive);
+int getPlaneCell(const Plane *plane, long long x, long long y);
+
+// Steps one generation on the given pool (NULL steps on the calling thread)
+// and returns the new number of alive cells. Falls back to not growing past
+// the existing chunks if a new one can't be allocated.
+long long stepPlane(Plane *plane, ThreadPool *pool);
+// Births are only counted on request, as it slows steps down a little
+void setPlaneBirthCounting(Plane *plane, int count);
+long long getPlanePopulation(const Plane *plane);
+PlaneStats getPlaneStats(const Plane *plane);
+
+#endif // PLANE_H
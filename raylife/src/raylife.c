@@ -6,17 +6,40 @@
  *   - Mouse Wheel: Zoom in/out
  *   - Space Key: Toggle between Play/Draw mode (only works if cells are alive)
  *   - UP Arrow: Increase generations interval
- *   - DOWN Arrow: Decrease generations interval
+ *   - DOWN Arrow: Decrease generations interval (0: as fast as possible)
+ *   - F Key: Turbo, as many generations per frame as fit the frame budget
+ *   - G Key: Show/hide the stats of the latest generations
+ *   - LEFT Arrow: Rewind one generation (with Shift: REWIND_JUMP generations)
  *   - R Key: Reset the grid
+ *   - H Key: Switch between the board and HashLife engines
+ *   - U Key: Switch between the board and the unbounded plane
+ *   - [ / ] Keys: Halve/double the HashLife step (2^k generations per step)
+ *   - T Key: Switch between drawing cells and uploading the board as a texture
+ *   - S Key: Save the board as a pattern file (raylife.rle by default)
+ *   - Drop a pattern file (.rle or .cells) on the window to place it
  *
  *******************************************************************************************/
 
+#include <stdatomic.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
+#include <time.h>
 
 #include "raylib.h"
 #include "raymath.h"
 
+#include "board.h"
+#include "cycle.h"
+#include "density.h"
+#include "hashlife.h"
+#include "history.h"
+#include "pattern.h"
+#include "plane.h"
+#include "simulation.h"
+#include "stats.h"
+
 //------------------------------------------------------------------------------------------
 // Constants Definition
 //------------------------------------------------------------------------------------------
@@ -29,41 +52,228 @@
 #define BOARD_COLS 500
 #define INIT_INTERVAL 0.2f
 #define MAX_GENERATIONS 500
+#define MIN_CAMERA_ZOOM 0.125f
+#define MAX_CAMERA_ZOOM 64.0f
+#define GRID_MIN_PIXELS 4.0f  // Grid lines are hidden below this cell size
+#define CELL_MIN_PIXELS 2.0f  // Smaller cells are drawn as a density heat map
+#define CELL_TEXTURE_MAX_SIZE 8192 // Widely supported GPU texture size limit
+#define EXPORT_FILE "raylife.rle"
+#define TURBO_BUDGET_MS 12.0 // Stepping time per frame in turbo mode
+#define SPEED_SAMPLE_TIME 0.5 // Seconds between generations/s updates
+#define REWIND_JUMP 100
+#define STATS_PLOT_HEIGHT 35 // Pixels of each sparkline in the stats overlay
+
+typedef enum { ENGINE_BOARD = 0, ENGINE_HASHLIFE, ENGINE_PLANE } Engine;
+typedef enum { RENDER_CELLS = 0, RENDER_TEXTURE } RenderMode;
 
+// Board cells [x0, x1) x [y0, y1)
 typedef struct {
-  int isAlive;
-  Vector2 pos;
-  Vector2 size;
-} Cell;
+  int x0, y0;
+  int x1, y1;
+} CellRange;
 
 //----------------------------------------------------------------------------------
 // Global Variables Definition
 //----------------------------------------------------------------------------------
-static Cell board[BOARD_ROWS][BOARD_COLS];
-static int aliveCells = 0;
-static int generations = 0;
-static int playMode = 0;
+static Board *board = NULL;
+static ThreadPool *pool = NULL;
+static HashLife *hashLife = NULL;
+static size_t hashLifeNodes = HASHLIFE_DEFAULT_NODES;
+static int hashLifeStepLog2 = 0;
+static Engine engine = ENGINE_BOARD;
+static Plane *plane = NULL;
+static long long originX = 0; // Plane cell of board cell (0, 0), the window
+static long long originY = 0; // the board shows of the unbounded plane
+static Simulation *simulation = NULL;
+static CycleDetector *cycles = NULL; // NULL with --no-cycles
+static unsigned cycleEdits = 0;      // Board edits the detector has seen
+static long long cyclePeriod = 0;
+static long long cycleStart = 0;     // Generation the period was found at
+static History *history = NULL;      // Board engine generations, GUI only
+static StatsRing *statsRing = NULL;  // Only with --stats when headless
+static int showStats = 0;
+static _Atomic float drawTime = 0.0f; // Of the last frame, read by the stepper
+// Owned by whoever holds the board: the simulation thread while it steps,
+// the main thread between lockSimulation() and unlockSimulation()
+static long long aliveCells = 0;
+static long long generations = 0;
+static int maxGenerations = MAX_GENERATIONS;
+static int turbo = 0;
+static int turboPlaying = 0; // Turbo steps on the main thread, not the simulation's
+static double turboBudget = TURBO_BUDGET_MS / 1000.0;
+static RenderMode renderMode = RENDER_CELLS;
+static int ruleFixed = 0; // Set by --rule, otherwise patterns bring theirs
+
+// Texture render mode: one grayscale texel per cell, re-uploaded where the
+// board differs from the cells of the last upload
+static Texture2D cellTexture = {0};
+static unsigned char *cellPixels = NULL;
+static uint64_t *uploadedCells = NULL;
+static uint64_t byteTexels[256]; // 8 cells of a byte as 8 texels
+
+// Far zoom: alive cells per block, created the first time it's needed
+static DensityPyramid *density = NULL;
 
 //----------------------------------------------------------------------------------
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
 static void initGrid(void);
-static void drawBoard(void);
-static void drawCells(void);
-static void updateBoard(void);
-static int countAliveNeighbors(int x, int y);
-static void toggleCells(int x, int y);
-static void nextGeneration(double *lastGenerationTime,
-                           float *generationInterval);
+static CellRange getVisibleCells(const Board *view, Camera2D camera);
+static void drawBoard(const Board *view, Camera2D camera);
+static void drawCells(const Board *view, Camera2D camera);
+static void drawDensity(const Board *view, CellRange range, float cellPixels);
+static int createCellTexture(void);
+static void destroyCellTexture(void);
+static void updateCellTexture(const Board *view);
+static void drawCellTexture(const Board *view);
+static void setRenderMode(RenderMode newRenderMode);
+static int getHashLifeStep(void);
+static int updateBoard(void);
+static long long detectCycle(void);
+static void recordStats(long long population, double stepTime);
+static int simulate(void *ctx);
+static void getSimulationStats(void *ctx, SimulationStats *stats);
+static void setPlayMode(int play);
+static void setTurbo(int enabled);
+static void stepTurbo(void);
+static void rewindBoard(long long generation);
+static void setEngine(Engine newEngine);
+static int setRule(Rule rule);
+static void getMouseCell(Camera2D camera, long long *x, long long *y);
+static void followCamera(Camera2D *camera);
+static void toggleCells(long long x, long long y);
+static int placePattern(const char *fileName, int x, int y, int centered);
+static void drawSparkline(const float *values, int count, int x, int y,
+                          float min, float max, Color color);
+static void drawStatsOverlay(const SimulationStats *stats);
+static double getWallTime(void);
+static int runHeadless(const char *statsFile);
 
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
 int main(int argc, char **argv) {
   // Parse command line arguments
-  int maxGenerations = argv[1] ? atoi(argv[1]) : MAX_GENERATIONS;
+  Engine startEngine = ENGINE_BOARD;
+  RenderMode startRenderMode = RENDER_CELLS;
+  int boardRows = BOARD_ROWS;
+  int boardCols = BOARD_COLS;
+  int threads = getDefaultThreadCount();
+  int headless = 0;
+  const char *patternFile = NULL;
+  const char *exportFile = NULL;
+  int patternX = 0, patternY = 0, patternAt = 0;
+  Rule rule = RULE_LIFE;
+  uint64_t seed = 0;
+  int detectCycles = 1;
+  size_t historyBytes = HISTORY_DEFAULT_BYTES;
+  const char *statsFile = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--rows") && i + 1 < argc)
+      boardRows = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--cols") && i + 1 < argc)
+      boardCols = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+      threads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--engine") && i + 1 < argc)
+      startEngine = !strcmp(argv[++i], "hashlife") ? ENGINE_HASHLIFE
+                    : !strcmp(argv[i], "plane")  ? ENGINE_PLANE
+                                                 : ENGINE_BOARD;
+    else if (!strcmp(argv[i], "--hashlife-nodes") && i + 1 < argc)
+      hashLifeNodes = strtoull(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "--hashlife-step") && i + 1 < argc)
+      hashLifeStepLog2 = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--headless"))
+      headless = 1;
+    else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+      seed = strtoull(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "--pattern") && i + 1 < argc)
+      patternFile = argv[++i];
+    else if (!strcmp(argv[i], "--rule") && i + 1 < argc) {
+      if (!parseRule(argv[++i], &rule)) {
+        fprintf(stderr, "Invalid rule %s, expected B/S notation\n", argv[i]);
+        return 1;
+      }
+      ruleFixed = 1;
+    } else if (!strcmp(argv[i], "--at") && i + 1 < argc)
+      patternAt = sscanf(argv[++i], "%d,%d", &patternX, &patternY) == 2;
+    else if (!strcmp(argv[i], "--export") && i + 1 < argc)
+      exportFile = argv[++i];
+    else if (!strcmp(argv[i], "--history-mb") && i + 1 < argc)
+      historyBytes = strtoull(argv[++i], NULL, 10) << 20;
+    else if (!strcmp(argv[i], "--stats") && i + 1 < argc)
+      statsFile = argv[++i];
+    else if (!strcmp(argv[i], "--no-cycles"))
+      detectCycles = 0;
+    else if (!strcmp(argv[i], "--turbo-budget") && i + 1 < argc)
+      turboBudget = atof(argv[++i]) / 1000.0;
+    else if (!strcmp(argv[i], "--render") && i + 1 < argc)
+      startRenderMode =
+          strcmp(argv[++i], "texture") ? RENDER_CELLS : RENDER_TEXTURE;
+    else
+      maxGenerations = atoi(argv[i]);
+  }
+
   if (maxGenerations < 1)
     maxGenerations = MAX_GENERATIONS;
+  if (boardRows < 1)
+    boardRows = BOARD_ROWS;
+  if (boardCols < 1)
+    boardCols = BOARD_COLS;
+  if (threads < 1)
+    threads = getDefaultThreadCount();
+  if (hashLifeStepLog2 < 0)
+    hashLifeStepLog2 = 0;
+  else if (hashLifeStepLog2 > HASHLIFE_MAX_STEP_LOG2)
+    hashLifeStepLog2 = HASHLIFE_MAX_STEP_LOG2;
+
+  board = createBoard(boardRows, boardCols);
+  if (!board) {
+    fprintf(stderr, "Could not allocate a %dx%d board\n", boardCols, boardRows);
+    return 1;
+  }
+
+  setBoardRule(board, rule);
+  board->countBirths = !headless || statsFile;
+  if (detectCycles)
+    cycles = createCycleDetector(CYCLE_DEFAULT_CAPACITY);
+
+  // Falls back to stepping on the main thread if the pool can't be created
+  pool = createThreadPool(threads);
+
+  // Patterns go top-left corner at --at, or centered on the board
+  if (!patternAt) {
+    patternX = board->cols / 2;
+    patternY = board->rows / 2;
+  }
+
+  if (headless) {
+    int result = 0;
+    if (!patternFile)
+      aliveCells = randomizeBoard(board, seed);
+    else if (!placePattern(patternFile, patternX, patternY, !patternAt)) {
+      fprintf(stderr, "Could not read pattern %s\n", patternFile);
+      result = 1;
+    }
+
+    if (!result) {
+      engine = startEngine;
+      result = runHeadless(statsFile);
+    }
+    if (!result && exportFile && !exportPattern(board, exportFile)) {
+      fprintf(stderr, "Could not write pattern %s\n", exportFile);
+      result = 1;
+    }
+
+    destroyHashLife(hashLife);
+    destroyPlane(plane);
+    destroyCycleDetector(cycles);
+    destroyStatsRing(statsRing);
+    destroyThreadPool(pool);
+    destroyBoard(board);
+    return result;
+  }
 
   InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "RayLife");
   SetTargetFPS(60);
@@ -72,24 +282,86 @@ int main(int argc, char **argv) {
   Camera2D camera = {0};
   camera.zoom = INITIAL_CAMERA_ZOOM;
   camera.offset = (Vector2){SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f};
-  camera.target = (Vector2){(BOARD_COLS * BOARD_SPACING) / 2.0f,
-                            (BOARD_ROWS * BOARD_SPACING) / 2.0f};
+  camera.target = (Vector2){(board->cols * BOARD_SPACING) / 2.0f,
+                            (board->rows * BOARD_SPACING) / 2.0f};
+
+  // Zooming out may go past the default floor until the whole board fits
+  float minZoom = fminf(
+      MIN_CAMERA_ZOOM,
+      fminf((float)SCREEN_WIDTH / (board->cols * BOARD_SPACING),
+            (float)SCREEN_HEIGHT / (board->rows * BOARD_SPACING)));
 
-  double lastGenerationTime = 0.0;
   float generations_interval = INIT_INTERVAL;
 
   initGrid();
+  setEngine(startEngine);
+  setRenderMode(startRenderMode);
+  if (patternFile && !placePattern(patternFile, patternX, patternY, !patternAt))
+    TraceLog(LOG_WARNING, "Could not read pattern %s", patternFile);
+  if (!exportFile)
+    exportFile = EXPORT_FILE;
+  if (historyBytes > 0)
+    history = createHistory(historyBytes);
+  statsRing = createStatsRing(STATS_DEFAULT_CAPACITY);
+
+  simulation = createSimulation(board, simulate, getSimulationStats, NULL);
+  if (!simulation) {
+    TraceLog(LOG_ERROR, "Could not start the simulation thread");
+    destroyCellTexture();
+    CloseWindow();
+    destroyHashLife(hashLife);
+    destroyPlane(plane);
+    destroyCycleDetector(cycles);
+    destroyHistory(history);
+    destroyStatsRing(statsRing);
+    destroyThreadPool(pool);
+    destroyBoard(board);
+    return 1;
+  }
+  setSimulationInterval(simulation, generations_interval);
+
+  // Generations/s, sampled from the snapshots
+  double speedTime = GetTime();
+  long long speedGeneration = 0;
+  double speed = 0.0;
 
   while (!WindowShouldClose()) {
-    if (aliveCells == 0) {
-      playMode = 0;
-      generations = 0;
+    if (turboPlaying)
+      stepTurbo();
+    if (engine == ENGINE_PLANE)
+      followCamera(&camera);
+
+    // Everything is drawn from the latest snapshot, the board itself may be
+    // in the middle of a step
+    const Snapshot *snapshot = acquireSnapshot(simulation);
+    const Board *view = &snapshot->view;
+    int playMode = turboPlaying || isSimulationPlaying(simulation);
+
+    double time = GetTime();
+    if (time - speedTime >= SPEED_SAMPLE_TIME) {
+      long long stepped = snapshot->stats.generation - speedGeneration;
+      speed = (playMode && stepped > 0) ? stepped / (time - speedTime) : 0.0;
+      speedTime = time;
+      speedGeneration = snapshot->stats.generation;
     }
 
-    // Toggle play/draw mode with space key
-    if (IsKeyPressed(KEY_SPACE) && aliveCells > 0 &&
-        generations < maxGenerations)
-      playMode = !playMode;
+    if (!playMode && view->population == 0 && snapshot->stats.generation) {
+      lockSimulation(simulation);
+      if (aliveCells == 0)
+        generations = 0;
+      unlockSimulation(simulation);
+    }
+
+    // Toggle play/draw mode with space key, or step once past the maximum
+    if (IsKeyPressed(KEY_SPACE)) {
+      if (view->population > 0 && snapshot->stats.generation < maxGenerations) {
+        setPlayMode(!playMode);
+      } else if (!playMode) {
+        lockSimulation(simulation);
+        generations += updateBoard();
+        unlockSimulation(simulation);
+      }
+    }
 
     // Move camera with right mouse button
     if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) {
@@ -107,16 +379,93 @@ int main(int argc, char **argv) {
       float scaleFactor = INITIAL_CAMERA_ZOOM + (ZOOM_SCALE * fabsf(wheel));
       if (wheel < 0)
         scaleFactor = INITIAL_CAMERA_ZOOM / scaleFactor;
-      camera.zoom = Clamp(camera.zoom * scaleFactor, 0.125f, 64.0f);
+      camera.zoom = Clamp(camera.zoom * scaleFactor, minZoom, MAX_CAMERA_ZOOM);
     }
 
     // Reset all with R key
     if (IsKeyPressed(KEY_R)) {
-      playMode = 0;
+      setPlayMode(0);
+      generations_interval = INIT_INTERVAL;
+      setSimulationInterval(simulation, generations_interval);
+      lockSimulation(simulation);
       generations = 0;
       aliveCells = 0;
-      generations_interval = INIT_INTERVAL;
       initGrid();
+      if (history)
+        clearHistory(history);
+      if (statsRing)
+        clearStatsRing(statsRing);
+      unlockSimulation(simulation);
+    }
+
+    // Switch simulation engine with H key
+    if (IsKeyPressed(KEY_H)) {
+      lockSimulation(simulation);
+      setEngine(engine == ENGINE_HASHLIFE ? ENGINE_BOARD : ENGINE_HASHLIFE);
+      unlockSimulation(simulation);
+    }
+
+    // Switch to the unbounded plane with U key
+    if (IsKeyPressed(KEY_U)) {
+      lockSimulation(simulation);
+      setEngine(engine == ENGINE_PLANE ? ENGINE_BOARD : ENGINE_PLANE);
+      unlockSimulation(simulation);
+    }
+
+    // Change the HashLife step size with [ and ] keys
+    if (IsKeyPressed(KEY_LEFT_BRACKET) && hashLifeStepLog2 > 0) {
+      lockSimulation(simulation);
+      hashLifeStepLog2--;
+      unlockSimulation(simulation);
+    }
+    if (IsKeyPressed(KEY_RIGHT_BRACKET) &&
+        hashLifeStepLog2 < HASHLIFE_MAX_STEP_LOG2) {
+      lockSimulation(simulation);
+      hashLifeStepLog2++;
+      unlockSimulation(simulation);
+    }
+
+    // Rewind with LEFT arrow, held down to keep going
+    if (IsKeyPressed(KEY_LEFT) || IsKeyPressedRepeat(KEY_LEFT)) {
+      int shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+      setPlayMode(0);
+      lockSimulation(simulation);
+      rewindBoard(generations - (shift ? REWIND_JUMP : 1));
+      unlockSimulation(simulation);
+    }
+
+    // Toggle turbo with F key
+    if (IsKeyPressed(KEY_F))
+      setTurbo(!turbo);
+
+    // Show the stats overlay with G key
+    if (IsKeyPressed(KEY_G))
+      showStats = !showStats;
+
+    // Switch render mode with T key
+    if (IsKeyPressed(KEY_T))
+      setRenderMode(renderMode == RENDER_CELLS ? RENDER_TEXTURE : RENDER_CELLS);
+
+    // Save the board with S key
+    if (IsKeyPressed(KEY_S)) {
+      if (exportPattern(view, exportFile))
+        TraceLog(LOG_INFO, "Board saved to %s", exportFile);
+      else
+        TraceLog(LOG_WARNING, "Could not write pattern %s", exportFile);
+    }
+
+    // Place dropped pattern files centered on the mouse
+    if (IsFileDropped()) {
+      FilePathList files = LoadDroppedFiles();
+      long long x, y;
+      getMouseCell(camera, &x, &y);
+      lockSimulation(simulation);
+      for (unsigned int i = 0; i < files.count; i++)
+        if (!placePattern(files.paths[i], (int)(x - originX),
+                          (int)(y - originY), 1))
+          TraceLog(LOG_WARNING, "Could not read pattern %s", files.paths[i]);
+      unlockSimulation(simulation);
+      UnloadDroppedFiles(files);
     }
 
     // Increase generations interval with UP arrow
@@ -124,6 +473,7 @@ int main(int argc, char **argv) {
       generations_interval += 0.1f;
       if (generations_interval > maxGenerations)
         generations_interval = maxGenerations;
+      setSimulationInterval(simulation, generations_interval);
     }
 
     // Decrease generations interval with DOWN arrow
@@ -131,46 +481,109 @@ int main(int argc, char **argv) {
       generations_interval -= 0.1f;
       if (generations_interval < 0.0)
         generations_interval = 0.0;
+      setSimulationInterval(simulation, generations_interval);
     }
 
     // Draw mode actions with left mouse button
     if (!playMode && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-      Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), camera);
-      int boardX = (int)(mousePos.x / BOARD_SPACING);
-      int boardY = (int)(mousePos.y / BOARD_SPACING);
-      toggleCells(boardX, boardY);
-    }
-
-    if (!playMode && IsKeyPressed(KEY_SPACE))
-      nextGeneration(&lastGenerationTime, &generations_interval);
-
-    // Start generations with space key
-    if (playMode && aliveCells > 0) {
-      nextGeneration(&lastGenerationTime, &generations_interval);
-      if (generations >= maxGenerations)
-        playMode = 0;
+      long long x, y;
+      getMouseCell(camera, &x, &y);
+      lockSimulation(simulation);
+      toggleCells(x, y);
+      unlockSimulation(simulation);
     }
 
+    // Draw time leaves out EndDrawing(), which waits for the next frame
+    double drawStart = GetTime();
     BeginDrawing();
     ClearBackground(BLACK);
 
-    DrawRectangle(5, 5, 300, 110, Fade(RAYWHITE, 0.9f));
-    DrawText(playMode ? "Play mode" : "Draw mode", 10, 10, 20, BLACK);
-    DrawText(
-        TextFormat("Generation: %d (Max: %d)", generations, maxGenerations), 10,
-        35, 20, BLACK);
-    DrawText(TextFormat("Cells: %d", aliveCells), 10, 60, 20, BLACK);
-    DrawText(TextFormat("Generation interval: %.1fs", generations_interval), 10,
-             85, 20, BLACK);
+    if (renderMode == RENDER_TEXTURE)
+      updateCellTexture(view);
 
     BeginMode2D(camera);
-    drawBoard();
-    drawCells();
+    if (renderMode == RENDER_TEXTURE) {
+      drawCellTexture(view);
+      drawBoard(view, camera);
+    } else {
+      drawBoard(view, camera);
+      drawCells(view, camera);
+    }
     EndMode2D();
+
+    DrawRectangle(5, 5, 300, 260, Fade(RAYWHITE, 0.9f));
+    DrawText(playMode ? (turbo ? "Play mode (turbo)" : "Play mode")
+                      : "Draw mode",
+             10, 10, 20, BLACK);
+    DrawText(TextFormat("Generation: %lld (Max: %d)", snapshot->stats.generation,
+                        maxGenerations),
+             10, 35, 20, BLACK);
+    DrawText(TextFormat("Cells: %lld", view->population), 10, 60, 20, BLACK);
+    DrawText(TextFormat("Generation interval: %.1fs", generations_interval), 10,
+             85, 20, BLACK);
+    DrawText(TextFormat("Speed: %.0f generations/s", speed), 10, 110, 20,
+             BLACK);
+    char ruleText[RULE_STRING_SIZE];
+    formatRule(view->rule, ruleText, sizeof(ruleText));
+    DrawText(TextFormat("Rule: %s", ruleText), 10, 135, 20, BLACK);
+    if (engine == ENGINE_HASHLIFE) {
+      HashLifeStats stats = snapshot->stats.hashLife;
+      long long lookups = stats.cacheHits + stats.cacheMisses;
+      DrawText(TextFormat("HashLife step: 2^%d", hashLifeStepLog2), 10, 160, 20,
+               BLACK);
+      DrawText(TextFormat("Nodes: %lld / %lld", stats.nodes, stats.nodeBudget),
+               10, 185, 20, BLACK);
+      DrawText(TextFormat("Cache hit rate: %.1f%%",
+                          lookups ? 100.0 * stats.cacheHits / lookups : 0.0),
+               10, 210, 20, BLACK);
+    } else if (engine == ENGINE_PLANE) {
+      PlaneStats stats = snapshot->stats.plane;
+      DrawText(TextFormat("Unbounded plane: %d threads", getThreadPoolSize(pool)),
+               10, 160, 20, BLACK);
+      DrawText(TextFormat("Chunks: %d active / %d (%d pooled)",
+                          stats.activeChunks, stats.chunks, stats.pooledChunks),
+               10, 185, 20, BLACK);
+      DrawText(TextFormat("View: %lld, %lld",
+                          originX + (long long)(camera.target.x / BOARD_SPACING),
+                          originY + (long long)(camera.target.y / BOARD_SPACING)),
+               10, 210, 20, BLACK);
+    } else {
+      DrawText(TextFormat("Board engine: %d threads", getThreadPoolSize(pool)),
+               10, 160, 20, BLACK);
+      DrawText(TextFormat("Active tiles: %d / %d", view->activeCount,
+                          view->tilesX * view->tilesY),
+               10, 185, 20, BLACK);
+      if (snapshot->stats.period > 0)
+        DrawText(TextFormat("Period: %lld (at generation %lld)",
+                            snapshot->stats.period, snapshot->stats.periodStart),
+                 10, 210, 20, BLACK);
+      else
+        DrawText("Period: none found", 10, 210, 20, BLACK);
+    }
+    if (history) {
+      HistoryStats stats = snapshot->stats.history;
+      DrawText(TextFormat("History: %d generations, %.1f MB", stats.records,
+                          stats.bytes / (1024.0 * 1024.0)),
+               10, 235, 20, BLACK);
+    }
+    if (showStats)
+      drawStatsOverlay(&snapshot->stats);
+    atomic_store_explicit(&drawTime, (float)(GetTime() - drawStart),
+                          memory_order_relaxed);
     EndDrawing();
   }
 
+  destroySimulation(simulation);
+  destroyCellTexture();
+  destroyDensityPyramid(density);
   CloseWindow();
+  destroyHashLife(hashLife);
+  destroyPlane(plane);
+  destroyCycleDetector(cycles);
+  destroyHistory(history);
+  destroyStatsRing(statsRing);
+  destroyThreadPool(pool);
+  destroyBoard(board);
 
   return 0;
 }
@@ -179,99 +592,759 @@ int main(int argc, char **argv) {
 // Module Functions Definition
 //----------------------------------------------------------------------------------
 static void initGrid(void) {
-  for (int i = 0; i < BOARD_ROWS; i++) {
-    for (int j = 0; j < BOARD_COLS; j++) {
-      board[i][j].isAlive = 0;
-      board[i][j].pos.x = j * BOARD_SPACING;
-      board[i][j].pos.y = i * BOARD_SPACING;
-      board[i][j].size.x = BOARD_SPACING;
-      board[i][j].size.y = BOARD_SPACING;
-    }
-  }
+  clearBoard(board);
+  if (engine == ENGINE_HASHLIFE)
+    loadHashLifeFromBoard(hashLife, board);
+  else if (engine == ENGINE_PLANE)
+    clearPlane(plane);
 }
 
-static void drawBoard(void) {
-  for (int i = 0; i <= BOARD_ROWS; i++) {
-    Vector2 start = {0, i * BOARD_SPACING};
-    Vector2 end = {BOARD_COLS * BOARD_SPACING, i * BOARD_SPACING};
+// Cells under the screen, from the world position of the screen corners
+static CellRange getVisibleCells(const Board *view, Camera2D camera) {
+  Vector2 topLeft = GetScreenToWorld2D((Vector2){0, 0}, camera);
+  Vector2 bottomRight =
+      GetScreenToWorld2D((Vector2){SCREEN_WIDTH, SCREEN_HEIGHT}, camera);
+  CellRange range = {0};
+
+  range.x0 = (int)Clamp(floorf(topLeft.x / BOARD_SPACING), 0, view->cols);
+  range.y0 = (int)Clamp(floorf(topLeft.y / BOARD_SPACING), 0, view->rows);
+  range.x1 = (int)Clamp(ceilf(bottomRight.x / BOARD_SPACING), 0, view->cols);
+  range.y1 = (int)Clamp(ceilf(bottomRight.y / BOARD_SPACING), 0, view->rows);
+
+  return range;
+}
+
+static void drawBoard(const Board *view, Camera2D camera) {
+  CellRange range = getVisibleCells(view, camera);
+
+  // Lines closer than a few pixels would just fill the screen with gray
+  if (BOARD_SPACING * camera.zoom < GRID_MIN_PIXELS)
+    return;
+
+  for (int i = range.y0; i <= range.y1; i++) {
+    Vector2 start = {range.x0 * BOARD_SPACING, i * BOARD_SPACING};
+    Vector2 end = {range.x1 * BOARD_SPACING, i * BOARD_SPACING};
     DrawLineV(start, end, GRAY);
   }
 
-  for (int j = 0; j <= BOARD_COLS; j++) {
-    Vector2 start = {j * BOARD_SPACING, 0};
-    Vector2 end = {j * BOARD_SPACING, BOARD_ROWS * BOARD_SPACING};
+  for (int j = range.x0; j <= range.x1; j++) {
+    Vector2 start = {j * BOARD_SPACING, range.y0 * BOARD_SPACING};
+    Vector2 end = {j * BOARD_SPACING, range.y1 * BOARD_SPACING};
     DrawLineV(start, end, GRAY);
   }
 }
 
-static int countAliveNeighbors(int x, int y) {
-  int count = 0;
+// Plane cell under the mouse, through the board window
+static void getMouseCell(Camera2D camera, long long *x, long long *y) {
+  Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), camera);
+
+  *x = originX + (long long)floorf(mousePos.x / BOARD_SPACING);
+  *y = originY + (long long)floorf(mousePos.y / BOARD_SPACING);
+}
+
+// The board window follows the camera over the plane, in whole chunks, once
+// the camera is a quarter of the window away from its center. The camera
+// target stays in board coordinates, small enough for a float.
+static void followCamera(Camera2D *camera) {
+  float dx = camera->target.x / BOARD_SPACING - board->cols / 2.0f;
+  float dy = camera->target.y / BOARD_SPACING - board->rows / 2.0f;
+  if (fabsf(dx) < board->cols / 4.0f && fabsf(dy) < board->rows / 4.0f)
+    return;
+
+  long long shiftX = (long long)roundf(dx / CHUNK_SIZE) * CHUNK_SIZE;
+  long long shiftY = (long long)roundf(dy / CHUNK_SIZE) * CHUNK_SIZE;
+  if (shiftX == 0 && shiftY == 0)
+    return;
+
+  lockSimulation(simulation);
+  originX += shiftX;
+  originY += shiftY;
+  storePlaneToBoard(plane, board, originX, originY);
+  unlockSimulation(simulation);
+
+  camera->target.x -= shiftX * BOARD_SPACING;
+  camera->target.y -= shiftY * BOARD_SPACING;
+}
+
+// Toggles plane cell (x, y), if it is inside the board window
+static void toggleCells(long long x, long long y) {
+  long long col = x - originX, row = y - originY;
+  if (col < 0 || col >= board->cols || row < 0 || row >= board->rows)
+    return;
+
+  int alive = toggleBoardCell(board, (int)col, (int)row);
+  aliveCells += (alive ? 1 : -1);
+  if (engine == ENGINE_HASHLIFE)
+    setHashLifeCell(hashLife, col, row, alive);
+  else if (engine == ENGINE_PLANE)
+    setPlaneCell(plane, x, y, alive);
+}
+
+// HashLife jumps 2^k generations, without overshooting the generations cap
+static int getHashLifeStep(void) {
+  int stepLog2 = hashLifeStepLog2;
+  while (stepLog2 > 0 && generations + (1LL << stepLog2) > maxGenerations)
+    stepLog2--;
+
+  return stepLog2;
+}
+
+// Advances the simulation and returns how many generations it moved
+static int updateBoard(void) {
+  if (engine == ENGINE_HASHLIFE) {
+    int stepLog2 = getHashLifeStep();
+    aliveCells = stepHashLife(hashLife, stepLog2);
+    storeHashLifeToBoard(hashLife, board);
+    return 1 << stepLog2;
+  }
+  if (engine == ENGINE_PLANE) {
+    aliveCells = stepPlane(plane, pool);
+    storePlaneToBoard(plane, board, originX, originY);
+    return 1;
+  }
+
+  // Edits since the last record are kept as a keyframe before stepping
+  if (history && !isHistoryCurrent(history, board))
+    recordHistory(history, board, generations, 1);
+  aliveCells = stepBoard(board, pool);
+  if (history)
+    recordHistory(history, board, generations + 1, 0);
+  return 1;
+}
+
+// The board keeps showing the same cells across a switch. HashLife and the
+// plane are unbounded, so cells that left the board are dropped when
+// switching away from them.
+static void setEngine(Engine newEngine) {
+  if (newEngine == ENGINE_HASHLIFE) {
+    if (!hashLife)
+      hashLife = createHashLife(hashLifeNodes, HASHLIFE_DEFAULT_CACHE_ENTRIES);
+    if (!hashLife)
+      return;
+    if (!setHashLifeRule(hashLife, board->rule)) {
+      TraceLog(LOG_WARNING, "HashLife can't run rules with births on 0");
+      return;
+    }
+
+    loadHashLifeFromBoard(hashLife, board);
+    aliveCells = getHashLifePopulation(hashLife);
+  } else if (newEngine == ENGINE_PLANE) {
+    if (!plane)
+      plane = createPlane();
+    if (!plane)
+      return;
+    setPlaneBirthCounting(plane, board->countBirths);
+    if (!setPlaneRule(plane, board->rule)) {
+      TraceLog(LOG_WARNING, "The plane can't run rules with births on 0");
+      return;
+    }
+
+    clearPlane(plane);
+    loadPlaneFromBoard(plane, board, originX, originY);
+    aliveCells = getPlanePopulation(plane);
+  } else {
+    aliveCells = refreshBoard(board);
+  }
+
+  engine = newEngine;
+}
+
+// Returns 0, keeping the current rule, if the engine can't run the new one
+static int setRule(Rule rule) {
+  if (engine == ENGINE_HASHLIFE && !setHashLifeRule(hashLife, rule))
+    return 0;
+  if (engine == ENGINE_PLANE && !setPlaneRule(plane, rule))
+    return 0;
+
+  setBoardRule(board, rule);
+  return 1;
+}
+
+// Bits of word w that fall inside columns [x0, x1)
+static uint64_t columnMask(int w, int x0, int x1) {
+  int lo = x0 - w * 64, hi = x1 - w * 64;
+  uint64_t mask = ~0ULL;
+
+  if (lo > 0)
+    mask &= ~0ULL << lo;
+  if (hi < 64)
+    mask &= (1ULL << hi) - 1;
+
+  return mask;
+}
+
+// Heat color of the fraction of alive cells in a block: blue and dim for
+// sparse blocks, through green, to bright red for full ones. Soups settle
+// at a few percent, so the scale is the square root of the density.
+static Color getDensityColor(float density) {
+  float heat = sqrtf(density);
+  return ColorFromHSV(240.0f * (1.0f - heat), 1.0f, 0.4f + 0.6f * heat);
+}
+
+// Level of detail for far zoom: the board is drawn as a heat map of the
+// density pyramid, one rectangle per non-empty block of the smallest level
+// whose blocks are CELL_MIN_PIXELS wide on screen
+static void drawDensity(const Board *view, CellRange range, float cellPixels) {
+  int levels = getDensityLevels(density);
+  int level = 1;
+  while (level < levels - 1 && (1 << level) * cellPixels < CELL_MIN_PIXELS)
+    level++;
 
-  // This is going to check the 8 surrounding cells
-  // If any of them are alive, then the cell is alive
-  for (int dy = -1; dy <= 1; dy++) {
-    for (int dx = -1; dx <= 1; dx++) {
-      if (dx == 0 && dy == 0)
+  int block = 1 << level;
+  updateDensityPyramid(density, view);
+
+  for (int by = range.y0 >> level; by <= (range.y1 - 1) >> level; by++) {
+    int y = by * block;
+    int height = (y + block < view->rows) ? block : view->rows - y;
+
+    for (int bx = range.x0 >> level; bx <= (range.x1 - 1) >> level; bx++) {
+      unsigned count = getDensityCount(density, level, bx, by);
+      if (!count)
         continue;
 
-      // Calculate the neighbor's coordinates
-      int nx = (x + dx + BOARD_COLS) % BOARD_COLS;
-      int ny = (y + dy + BOARD_ROWS) % BOARD_ROWS;
+      int x = bx * block;
+      int width = (x + block < view->cols) ? block : view->cols - x;
+      Vector2 pos = {x * BOARD_SPACING, y * BOARD_SPACING};
+      Vector2 size = {width * BOARD_SPACING, height * BOARD_SPACING};
+      DrawRectangleV(pos, size,
+                     getDensityColor((float)count / (width * height)));
+    }
+  }
+}
+
+static void drawCells(const Board *view, Camera2D camera) {
+  CellRange range = getVisibleCells(view, camera);
+  float cellPixels = BOARD_SPACING * camera.zoom;
+  Vector2 size = {BOARD_SPACING, BOARD_SPACING};
+
+  if (range.x0 >= range.x1 || range.y0 >= range.y1)
+    return;
 
-      count += board[ny][nx].isAlive;
+  // Falls back to drawing every cell if the pyramid can't be allocated
+  if (cellPixels < CELL_MIN_PIXELS && !density)
+    density = createDensityPyramid(view->rows, view->cols);
+  if (cellPixels < CELL_MIN_PIXELS && density) {
+    drawDensity(view, range, cellPixels);
+    return;
+  }
+
+  // Only visible, non-empty tiles are visited
+  int tx0 = range.x0 >> 6, tx1 = (range.x1 + 63) >> 6;
+  int ty0 = range.y0 / TILE_ROWS, ty1 = (range.y1 + TILE_ROWS - 1) / TILE_ROWS;
+
+  for (int ty = ty0; ty < ty1; ty++) {
+    int r0 = (ty * TILE_ROWS > range.y0) ? ty * TILE_ROWS : range.y0;
+    int r1 = ((ty + 1) * TILE_ROWS < range.y1) ? (ty + 1) * TILE_ROWS : range.y1;
+
+    for (int w = tx0; w < tx1; w++) {
+      if (!view->tilePopulation[ty * view->tilesX + w])
+        continue;
+
+      uint64_t mask = columnMask(w, range.x0, range.x1);
+      for (int i = r0; i < r1; i++) {
+        // Visit only the set bits of each word
+        for (uint64_t bits = boardRow(view, i)[w] & mask; bits;
+             bits &= bits - 1) {
+          int j = w * 64 + __builtin_ctzll(bits);
+          Vector2 pos = {j * BOARD_SPACING, i * BOARD_SPACING};
+          DrawRectangleV(pos, size, WHITE);
+          Rectangle rec = {pos.x, pos.y, size.x, size.y};
+          DrawRectangleLinesEx(rec, 1, BLACK);
+        }
+      }
     }
   }
+}
+
+static int createCellTexture(void) {
+  if (board->cols > CELL_TEXTURE_MAX_SIZE ||
+      board->rows > CELL_TEXTURE_MAX_SIZE) {
+    TraceLog(LOG_WARNING, "Board is too large for texture render mode");
+    return 0;
+  }
+
+  cellPixels = calloc((size_t)board->rows * board->cols, 1);
+  uploadedCells = calloc((size_t)board->rows * board->words, sizeof(uint64_t));
+  if (!cellPixels || !uploadedCells) {
+    destroyCellTexture();
+    return 0;
+  }
+
+  // Both start out all dead, so they match the uploaded texture
+  Image image = {cellPixels, board->cols, board->rows, 1,
+                 PIXELFORMAT_UNCOMPRESSED_GRAYSCALE};
+  cellTexture = LoadTextureFromImage(image);
+  if (cellTexture.id == 0) {
+    destroyCellTexture();
+    return 0;
+  }
+  SetTextureFilter(cellTexture, TEXTURE_FILTER_POINT);
 
-  return count;
+  for (int b = 0; b < 256; b++) {
+    byteTexels[b] = 0;
+    for (int k = 0; k < 8; k++)
+      if ((b >> k) & 1)
+        byteTexels[b] |= 0xFFULL << (k * 8);
+  }
+
+  return 1;
+}
+
+static void destroyCellTexture(void) {
+  if (cellTexture.id > 0)
+    UnloadTexture(cellTexture);
+  cellTexture = (Texture2D){0};
+  free(cellPixels);
+  free(uploadedCells);
+  cellPixels = NULL;
+  uploadedCells = NULL;
 }
 
-static void toggleCells(int x, int y) {
-  if (x >= 0 && x < BOARD_COLS && y >= 0 && y < BOARD_ROWS) {
-    board[y][x].isAlive = !board[y][x].isAlive;
-    aliveCells += (board[y][x].isAlive ? 1 : -1);
+// Expands rows [r0, r1) of the board to texels
+static void writeCellPixels(const Board *view, int r0, int r1) {
+  int cols = view->cols;
+
+  for (int i = r0; i < r1; i++) {
+    const uint64_t *row = boardRow(view, i);
+    unsigned char *pixels = cellPixels + (size_t)i * cols;
+
+    for (int j = 0; j < cols; j += 8) {
+      uint64_t texels = byteTexels[(row[j >> 6] >> (j & 63)) & 0xFF];
+      memcpy(pixels + j, &texels, (cols - j < 8) ? cols - j : 8);
+    }
   }
 }
 
-static void updateBoard(void) {
-  Cell nextGrid[BOARD_ROWS][BOARD_COLS];
-  int newAliveCells = 0;
+// Compares each tile row band with the last upload, and uploads runs of
+// changed bands with one UpdateTextureRec each. A still board costs a memcmp.
+static void updateCellTexture(const Board *view) {
+  int rows = view->rows, words = view->words;
+  int dirtyStart = -1;
+
+  // One band past the last flushes the final run
+  for (int band = 0; band <= view->tilesY; band++) {
+    int r0 = (band * TILE_ROWS < rows) ? band * TILE_ROWS : rows;
+    int r1 = (r0 + TILE_ROWS < rows) ? r0 + TILE_ROWS : rows;
+    size_t offset = (size_t)r0 * words;
+    size_t bytes = (size_t)(r1 - r0) * words * sizeof(uint64_t);
+    int dirty = (band < view->tilesY) &&
+                memcmp(view->cells + offset, uploadedCells + offset, bytes);
 
-  for (int i = 0; i < BOARD_ROWS; i++) {
-    for (int j = 0; j < BOARD_COLS; j++) {
-      int aliveNeighbors = countAliveNeighbors(j, i);
-      nextGrid[i][j] = board[i][j];
-      nextGrid[i][j].isAlive = (board[i][j].isAlive &&
-                                (aliveNeighbors == 2 || aliveNeighbors == 3)) ||
-                               (!board[i][j].isAlive && aliveNeighbors == 3);
-      if (nextGrid[i][j].isAlive)
-        newAliveCells++;
+    if (dirty) {
+      memcpy(uploadedCells + offset, view->cells + offset, bytes);
+      writeCellPixels(view, r0, r1);
+      if (dirtyStart < 0)
+        dirtyStart = r0;
+    } else if (dirtyStart >= 0) {
+      Rectangle rec = {0, dirtyStart, view->cols, r0 - dirtyStart};
+      UpdateTextureRec(cellTexture, rec,
+                       cellPixels + (size_t)dirtyStart * view->cols);
+      dirtyStart = -1;
     }
   }
+}
+
+// The whole board as one quad, texels scaled up to cells
+static void drawCellTexture(const Board *view) {
+  Rectangle source = {0, 0, view->cols, view->rows};
+  Rectangle dest = {0, 0, view->cols * BOARD_SPACING,
+                    view->rows * BOARD_SPACING};
 
-  memcpy(board, nextGrid, sizeof(board));
-  aliveCells = newAliveCells;
+  DrawTexturePro(cellTexture, source, dest, (Vector2){0, 0}, 0.0f, WHITE);
 }
 
-static void drawCells(void) {
-  for (int i = 0; i < BOARD_ROWS; i++) {
-    for (int j = 0; j < BOARD_COLS; j++) {
-      if (board[i][j].isAlive) {
-        DrawRectangleV(board[i][j].pos, board[i][j].size, WHITE);
-        Rectangle rec = {board[i][j].pos.x, board[i][j].pos.y,
-                         board[i][j].size.x, board[i][j].size.y};
-        DrawRectangleLinesEx(rec, 1, BLACK);
-      }
+// Texture mode needs its buffers, otherwise cells are drawn one by one
+static void setRenderMode(RenderMode newRenderMode) {
+  if (newRenderMode == RENDER_TEXTURE && cellTexture.id == 0 &&
+      !createCellTexture())
+    newRenderMode = RENDER_CELLS;
+
+  renderMode = newRenderMode;
+}
+
+// One pixel column per value, scaled so [min, max] fills STATS_PLOT_HEIGHT
+static void drawSparkline(const float *values, int count, int x, int y,
+                          float min, float max, Color color) {
+  float scale = (max > min) ? STATS_PLOT_HEIGHT / (max - min) : 0.0f;
+  int bottom = y + STATS_PLOT_HEIGHT;
+
+  for (int i = 1; i < count; i++)
+    DrawLine(x + i - 1, bottom - (int)((values[i - 1] - min) * scale), x + i,
+             bottom - (int)((values[i] - min) * scale), color);
+}
+
+// Population, births and deaths, and step and draw times of the latest
+// generations in the snapshot. Engines that don't count births (HashLife)
+// plot them as 0.
+static void drawStatsOverlay(const SimulationStats *stats) {
+  const GenerationStats *recent = stats->recent;
+  int count = stats->recentCount;
+  float population[SIMULATION_RECENT_STATS], births[SIMULATION_RECENT_STATS];
+  float deaths[SIMULATION_RECENT_STATS], stepTimes[SIMULATION_RECENT_STATS];
+  float drawTimes[SIMULATION_RECENT_STATS];
+  float minPopulation = 0.0f, maxPopulation = 0.0f, maxChanges = 0.0f;
+  float maxTime = 0.0f;
+
+  for (int i = 0; i < count; i++) {
+    population[i] = (float)recent[i].population;
+    births[i] = (float)((recent[i].births > 0) ? recent[i].births : 0);
+    deaths[i] = (float)((recent[i].deaths > 0) ? recent[i].deaths : 0);
+    stepTimes[i] = recent[i].stepTime * 1000.0f;
+    drawTimes[i] = recent[i].drawTime * 1000.0f;
+    if (i == 0 || population[i] < minPopulation)
+      minPopulation = population[i];
+    maxPopulation = fmaxf(maxPopulation, population[i]);
+    maxChanges = fmaxf(maxChanges, fmaxf(births[i], deaths[i]));
+    maxTime = fmaxf(maxTime, fmaxf(stepTimes[i], drawTimes[i]));
+  }
+
+  int sectionHeight = STATS_PLOT_HEIGHT + 25;
+  int x = 11, y = SCREEN_HEIGHT - 3 * sectionHeight - 10;
+  DrawRectangle(5, y - 5, 300, 3 * sectionHeight + 10, Fade(RAYWHITE, 0.9f));
+  if (count == 0) {
+    DrawText("No generations stepped yet", 10, y, 20, BLACK);
+    return;
+  }
+
+  const GenerationStats *last = &recent[count - 1];
+  DrawText(TextFormat("Population: %lld", last->population), 10, y, 20, BLACK);
+  drawSparkline(population, count, x, y + 22, minPopulation, maxPopulation,
+                DARKBLUE);
+
+  y += sectionHeight;
+  if (last->births >= 0)
+    DrawText(TextFormat("Births: %lld", last->births), 10, y, 20, DARKGREEN);
+  else
+    DrawText("Births: not counted", 10, y, 20, DARKGREEN);
+  if (last->deaths >= 0)
+    DrawText(TextFormat("Deaths: %lld", last->deaths), 160, y, 20, MAROON);
+  drawSparkline(births, count, x, y + 22, 0.0f, maxChanges, DARKGREEN);
+  drawSparkline(deaths, count, x, y + 22, 0.0f, maxChanges, MAROON);
+
+  y += sectionHeight;
+  DrawText(TextFormat("Step: %.2f ms", last->stepTime * 1000.0f), 10, y, 20,
+           DARKPURPLE);
+  DrawText(TextFormat("Draw: %.2f ms", last->drawTime * 1000.0f), 160, y, 20,
+           ORANGE);
+  drawSparkline(stepTimes, count, x, y + 22, 0.0f, maxTime, DARKPURPLE);
+  drawSparkline(drawTimes, count, x, y + 22, 0.0f, maxTime, ORANGE);
+}
+
+// Records the board engine's latest generation. Once the board repeats, the
+// generations left up to maxGenerations only go around the cycle, so the
+// last one is reached by stepping the remainder of their division by the
+// period. Returns the number of generations skipped.
+static long long detectCycle(void) {
+  if (!cycles || engine != ENGINE_BOARD)
+    return 0;
+
+  // Any edit starts a new history
+  if (board->edits != cycleEdits) {
+    resetCycleDetector(cycles);
+    cycleEdits = board->edits;
+    cyclePeriod = 0;
+  }
+  if (cyclePeriod > 0)
+    return 0;
+
+  cyclePeriod = checkCycle(cycles, board->hash, generations);
+  if (cyclePeriod == 0)
+    return 0;
+
+  cycleStart = generations;
+  long long left = maxGenerations - generations;
+  if (left <= 0)
+    return 0;
+
+  for (long long i = left % cyclePeriod; i > 0; i--)
+    aliveCells = stepBoard(board, pool);
+  generations = maxGenerations;
+  if (history)
+    recordHistory(history, board, generations, 1);
+  return left;
+}
+
+// Adds the generation just stepped to the stats ring. The population is
+// the one before the step: what it did not gain from births, deaths took.
+static void recordStats(long long population, double stepTime) {
+  if (!statsRing)
+    return;
+
+  GenerationStats stats = {0};
+  stats.generation = generations;
+  stats.population = aliveCells;
+  stats.births = -1;
+  stats.active = -1;
+  if (engine == ENGINE_BOARD) {
+    stats.births = board->births;
+    stats.active = board->activeCount;
+  } else if (engine == ENGINE_PLANE) {
+    PlaneStats planeStats = getPlaneStats(plane);
+    stats.births = planeStats.births;
+    stats.active = planeStats.activeChunks;
+  }
+  stats.deaths = (stats.births >= 0) ? stats.births - (aliveCells - population)
+                                     : -1;
+  stats.stepTime = (float)stepTime;
+  stats.drawTime = atomic_load_explicit(&drawTime, memory_order_relaxed);
+  pushStats(statsRing, &stats);
+}
+
+// Runs on the simulation thread while playing
+static int simulate(void *ctx) {
+  (void)ctx;
+  if (aliveCells == 0 || generations >= maxGenerations)
+    return 0;
+
+  long long population = aliveCells;
+  double start = getWallTime();
+  int stepped = updateBoard();
+  generations += stepped;
+  recordStats(population, getWallTime() - start);
+  return stepped + (int)detectCycle();
+}
+
+static void getSimulationStats(void *ctx, SimulationStats *stats) {
+  (void)ctx;
+  stats->generation = generations;
+  stats->period = (board->edits == cycleEdits) ? cyclePeriod : 0;
+  stats->periodStart = cycleStart;
+  if (engine == ENGINE_HASHLIFE)
+    stats->hashLife = getHashLifeStats(hashLife);
+  else if (engine == ENGINE_PLANE)
+    stats->plane = getPlaneStats(plane);
+  if (history)
+    stats->history = getHistoryStats(history);
+  stats->recentCount =
+      statsRing ? copyRecentStats(statsRing, stats->recent,
+                                  SIMULATION_RECENT_STATS)
+                : 0;
+}
+
+static void setPlayMode(int play) {
+  if (turbo)
+    turboPlaying = play;
+  else
+    playSimulation(simulation, play);
+}
+
+// Turbo moves playing between the simulation thread and the main thread
+static void setTurbo(int enabled) {
+  int playing = turboPlaying || isSimulationPlaying(simulation);
+
+  setPlayMode(0);
+  turbo = enabled;
+  setPlayMode(playing);
+}
+
+// Steps as many generations as fit in the frame's turbo budget, measured
+// with GetTime() so the count follows the board size and engine. Only the
+// last generation is published, and drawn.
+static void stepTurbo(void) {
+  lockSimulation(simulation);
+
+  double start = GetTime();
+  do {
+    if (!simulate(NULL)) {
+      turboPlaying = 0;
+      break;
     }
+  } while (GetTime() - start < turboBudget);
+
+  unlockSimulation(simulation);
+}
+
+// Goes back to the latest recorded generation up to the given one. Only the
+// board engine's generations are recorded.
+static void rewindBoard(long long generation) {
+  if (!history || generation < 0)
+    return;
+
+  long long restored = restoreHistory(history, board, generation);
+  if (restored < 0)
+    return;
+
+  generations = restored;
+  aliveCells = board->population;
+  if (engine == ENGINE_HASHLIFE) {
+    loadHashLifeFromBoard(hashLife, board);
+  } else if (engine == ENGINE_PLANE) {
+    loadPlaneFromBoard(plane, board, originX, originY);
+    aliveCells = getPlanePopulation(plane);
   }
 }
 
-static void nextGeneration(double *lastGenerationTime,
-                           float *generations_interval) {
-  double time = GetTime();
+// Loads a pattern file onto the board with its top-left corner at (x, y), or
+// centered on (x, y). Returns 0 if the file can't be read.
+static int placePattern(const char *fileName, int x, int y, int centered) {
+  PatternInfo info;
+  if (!getPatternInfo(fileName, &info))
+    return 0;
 
-  if (time - *lastGenerationTime >= *generations_interval) {
-    updateBoard();
-    generations++;
-    *lastGenerationTime = time;
+  if (info.hasRule && !ruleFixed && !setRule(info.rule))
+    TraceLog(LOG_WARNING, "Pattern rule not supported by the engine");
+
+  if (centered) {
+    x -= info.width / 2;
+    y -= info.height / 2;
+  }
+  if (loadPattern(board, fileName, x, y) < 0)
+    return 0;
+
+  if (engine == ENGINE_HASHLIFE) {
+    loadHashLifeFromBoard(hashLife, board);
+    aliveCells = getHashLifePopulation(hashLife);
+  } else if (engine == ENGINE_PLANE) {
+    loadPlaneFromBoard(plane, board, originX, originY);
+    aliveCells = getPlanePopulation(plane);
+  } else {
+    aliveCells = board->population;
   }
+
+  return 1;
+}
+
+static double getWallTime(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Runs maxGenerations generations without a window as fast as possible and
+// prints the timings. The board engine skips ahead once the board repeats,
+// unless run with --no-cycles, and the rates only count the generations
+// actually stepped. The checksum identifies the final board, so
+// changes to the stepping code can be checked for identical results. With a
+// stats file, the stats of every generation are written to it as CSV.
+static int runHeadless(const char *statsFile) {
+
+  if (engine == ENGINE_HASHLIFE) {
+    hashLife = createHashLife(hashLifeNodes, HASHLIFE_DEFAULT_CACHE_ENTRIES);
+    if (!hashLife) {
+      fprintf(stderr, "Could not allocate the HashLife engine\n");
+      return 1;
+    }
+    if (!setHashLifeRule(hashLife, board->rule)) {
+      fprintf(stderr, "HashLife can't run rules with births on 0\n");
+      return 1;
+    }
+    loadHashLifeFromBoard(hashLife, board);
+  } else if (engine == ENGINE_PLANE) {
+    plane = createPlane();
+    if (!plane) {
+      fprintf(stderr, "Could not allocate the plane\n");
+      return 1;
+    }
+    setPlaneBirthCounting(plane, board->countBirths);
+    if (!setPlaneRule(plane, board->rule)) {
+      fprintf(stderr, "The plane can't run rules with births on 0\n");
+      return 1;
+    }
+    loadPlaneFromBoard(plane, board, 0, 0);
+  }
+
+  FILE *stats = NULL;
+  if (statsFile) {
+    statsRing = createStatsRing(STATS_DEFAULT_CAPACITY);
+    stats = fopen(statsFile, "w");
+    if (!statsRing || !stats) {
+      fprintf(stderr, "Could not write stats to %s\n", statsFile);
+      if (stats)
+        fclose(stats);
+      return 1;
+    }
+  }
+
+  double start = getWallTime();
+  int statsWritten = 1;
+  long long stepped = 0; // Generations simulated, the rates count only these
+  long long skipped = 0; // Generations skipped over a cycle
+
+  // HashLife and the plane are only written back to the board at the end.
+  // Stats are written out whenever the ring is full, so none is lost.
+  while (generations < maxGenerations) {
+    long long population = aliveCells;
+    double stepStart = stats ? getWallTime() : 0.0;
+
+    if (engine == ENGINE_HASHLIFE) {
+      int stepLog2 = getHashLifeStep();
+      aliveCells = stepHashLife(hashLife, stepLog2);
+      generations += 1 << stepLog2;
+      stepped += 1 << stepLog2;
+    } else if (engine == ENGINE_PLANE) {
+      aliveCells = stepPlane(plane, pool);
+      generations++;
+      stepped++;
+    } else {
+      aliveCells = stepBoard(board, pool);
+      generations++;
+      stepped++;
+    }
+
+    if (stats) {
+      recordStats(population, getWallTime() - stepStart);
+      if (getUnwrittenStats(statsRing) == STATS_DEFAULT_CAPACITY)
+        statsWritten &= writeStatsCsv(statsRing, stats);
+    }
+    // The remainder of the cycle is stepped, the whole periods skipped
+    long long left = detectCycle();
+    if (left > 0) {
+      stepped += left % cyclePeriod;
+      skipped = left - left % cyclePeriod;
+    }
+  }
+  if (engine == ENGINE_HASHLIFE)
+    storeHashLifeToBoard(hashLife, board);
+  else if (engine == ENGINE_PLANE)
+    storePlaneToBoard(plane, board, 0, 0);
+
+  double seconds = getWallTime() - start;
+  if (stats) {
+    statsWritten &= writeStatsCsv(statsRing, stats);
+    statsWritten &= !fclose(stats);
+    if (!statsWritten) {
+      fprintf(stderr, "Could not write stats to %s\n", statsFile);
+      return 1;
+    }
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  printf("Engine: %s\n", (engine == ENGINE_HASHLIFE) ? "hashlife"
+                         : (engine == ENGINE_PLANE)  ? "plane"
+                                                     : "board");
+  char rule[RULE_STRING_SIZE];
+  formatRule(board->rule, rule, sizeof(rule));
+  printf("Board: %dx%d\n", board->cols, board->rows);
+  printf("Rule: %s\n", rule);
+  printf("Threads: %d\n", getThreadPoolSize(pool));
+  printf("Generations: %lld\n", generations);
+  printf("Wall time: %.3f s\n", seconds);
+  printf("Stepped: %lld\n", stepped);
+  printf("Generations/s: %.1f\n", stepped / seconds);
+  printf("Cell updates/s: %.3e\n",
+         (double)stepped * board->rows * board->cols / seconds);
+  printf("Peak RSS: %ld KB\n", usage.ru_maxrss);
+  if (engine == ENGINE_HASHLIFE) {
+    // To size --hashlife-nodes: the capacity grows past the budget when a
+    // step needs more nodes than the collections leave room for
+    HashLifeStats hashLifeStats = getHashLifeStats(hashLife);
+    long long lookups = hashLifeStats.cacheHits + hashLifeStats.cacheMisses;
+    printf("HashLife nodes: %lld / %lld (capacity %lld)\n", hashLifeStats.nodes,
+           hashLifeStats.nodeBudget, hashLifeStats.nodeCapacity);
+    printf("HashLife cache hit rate: %.1f%% (%lld lookups)\n",
+           lookups ? 100.0 * hashLifeStats.cacheHits / lookups : 0.0, lookups);
+    printf("HashLife collections: %d\n", hashLifeStats.collections);
+  }
+  if (cyclePeriod > 0)
+    printf("Period: %lld (at generation %lld)\n", cyclePeriod, cycleStart);
+  else
+    printf("Period: none found\n");
+  if (skipped > 0)
+    printf("Skipped: cycle of period %lld detected at %lld, skipped %lld\n",
+           cyclePeriod, cycleStart, skipped);
+  printf("Population: %lld\n", aliveCells);
+  printf("Checksum: %016llx\n", (unsigned long long)getBoardChecksum(board));
+
+  return 0;
 }
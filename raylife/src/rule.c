@@ -0,0 +1,73 @@
+#include "rule.h"
+
+#include <ctype.h>
+#include <stdio.h>
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+// Reads neighbor counts into a mask, up to the first character that isn't
+// a digit. Returns 0 on a digit over 8.
+static int parseCounts(const char **text, uint16_t *mask) {
+  for (; isdigit((unsigned char)**text); (*text)++) {
+    int n = **text - '0';
+    if (n > 8)
+      return 0;
+    *mask |= 1 << n;
+  }
+
+  return 1;
+}
+
+int parseRule(const char *text, Rule *rule) {
+  Rule parsed = {0, 0};
+  int letters = 0;
+
+  while (isspace((unsigned char)*text))
+    text++;
+
+  // "B3/S23", "S23/B3", or without the slash
+  for (const char *c = text; *c; c++)
+    if (*c == 'B' || *c == 'b' || *c == 'S' || *c == 's')
+      letters = 1;
+
+  if (letters) {
+    while (*text && !isspace((unsigned char)*text)) {
+      char key = (char)tolower((unsigned char)*text++);
+      if (key == '/')
+        continue;
+      if (key != 'b' && key != 's')
+        return 0;
+      if (!parseCounts(&text, (key == 'b') ? &parsed.birth : &parsed.survival))
+        return 0;
+    }
+  } else {
+    // "23/3": survival first
+    if (!parseCounts(&text, &parsed.survival) || *text++ != '/' ||
+        !parseCounts(&text, &parsed.birth))
+      return 0;
+    if (*text && !isspace((unsigned char)*text))
+      return 0;
+  }
+
+  *rule = parsed;
+  return 1;
+}
+
+void formatRule(Rule rule, char *text, size_t size) {
+  char buffer[RULE_STRING_SIZE];
+  int length = 0;
+
+  buffer[length++] = 'B';
+  for (int n = 0; n <= 8; n++)
+    if ((rule.birth >> n) & 1)
+      buffer[length++] = (char)('0' + n);
+  buffer[length++] = '/';
+  buffer[length++] = 'S';
+  for (int n = 0; n <= 8; n++)
+    if ((rule.survival >> n) & 1)
+      buffer[length++] = (char)('0' + n);
+  buffer[length] = '\0';
+
+  snprintf(text, size, "%s", buffer);
+}
@@ -0,0 +1,52 @@
+/*******************************************************************************************
+ *
+ *   Rule: outer-totalistic Life-like rules in B/S notation
+ *
+ *   A rule says for how many alive neighbors (0 to 8) a dead cell is born
+ *   and an alive cell survives: "B3/S23" is Conway's Life, "B36/S23"
+ *   HighLife and "B3678/S34678" Day & Night. The older "S/B" notation
+ *   ("23/3") is accepted too.
+ *
+ *******************************************************************************************/
+
+#ifndef RULE_H
+#define RULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define RULE_STRING_SIZE 24 // Longest rulestring written, "B012345678/S012345678"
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Bit n of each mask is set for n alive neighbors
+typedef struct {
+  uint16_t birth;
+  uint16_t survival;
+} Rule;
+
+#define RULE_LIFE ((Rule){0x008, 0x00C})          // B3/S23
+#define RULE_HIGHLIFE ((Rule){0x048, 0x00C})      // B36/S23
+#define RULE_DAY_AND_NIGHT ((Rule){0x1C8, 0x1D8}) // B3678/S34678
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// Returns 0 if the text is not a valid rulestring
+int parseRule(const char *text, Rule *rule);
+// Writes the rule in B/S notation
+void formatRule(Rule rule, char *text, size_t size);
+
+static inline int isSameRule(Rule a, Rule b) {
+  return a.birth == b.birth && a.survival == b.survival;
+}
+
+static inline int getRuleNextState(Rule rule, int alive, int neighbors) {
+  return ((alive ? rule.survival : rule.birth) >> neighbors) & 1;
+}
+
+#endif // RULE_H
@@ -0,0 +1,276 @@
+#include "simulation.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define SNAPSHOT_INDEX 3 // Low bits of the shared slot: the snapshot index
+#define SNAPSHOT_FRESH 4 // Set when the shared snapshot was not read yet
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct Simulation {
+  Board *board;
+  SimulationStepFunc step;
+  SimulationStatsFunc stats;
+  void *ctx;
+
+  // Triple buffer: the writer fills back, the reader owns front, and the
+  // shared slot is swapped with either of them
+  Snapshot snapshots[3];
+  int back;
+  int front;
+  _Atomic int shared;
+
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t wake; // Signaled when the thread has something to do
+  pthread_cond_t idle; // Signaled when a step ends
+  int playing;
+  int holders;    // Threads holding the board, the thread waits for them
+  int stepping;   // The thread is stepping or publishing
+  int unpublished; // Generations stepped since the last snapshot
+  int quit;
+  double interval;
+  struct timespec nextStep;
+};
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+static int createSnapshot(Snapshot *snapshot, const Board *board) {
+  size_t tiles = (size_t)board->tilesX * board->tilesY;
+
+  snapshot->view = *board;
+  snapshot->view.cells = calloc((size_t)board->rows * board->words,
+                                sizeof(uint64_t));
+  snapshot->view.tilePopulation = calloc(tiles, sizeof(uint16_t));
+  snapshot->view.tileHash = calloc(tiles, sizeof(uint64_t));
+  snapshot->view.next = NULL;
+  snapshot->view.tileChanged = NULL;
+  snapshot->view.activeTiles = NULL;
+  snapshot->view.workerAlive = NULL;
+
+  return snapshot->view.cells && snapshot->view.tilePopulation &&
+         snapshot->view.tileHash;
+}
+
+static void destroySnapshot(Snapshot *snapshot) {
+  free(snapshot->view.cells);
+  free(snapshot->view.tilePopulation);
+  free(snapshot->view.tileHash);
+}
+
+// Copies the board into the back snapshot and swaps it into the shared slot.
+// Only the thread holding the board may publish.
+static void publish(Simulation *sim) {
+  const Board *board = sim->board;
+  Snapshot *snapshot = &sim->snapshots[sim->back];
+  uint64_t *cells = snapshot->view.cells;
+  uint16_t *population = snapshot->view.tilePopulation;
+  uint64_t *tileHash = snapshot->view.tileHash;
+  size_t tiles = (size_t)board->tilesX * board->tilesY;
+
+  memcpy(cells, board->cells,
+         (size_t)board->rows * board->words * sizeof(uint64_t));
+  memcpy(population, board->tilePopulation, tiles * sizeof(uint16_t));
+  memcpy(tileHash, board->tileHash, tiles * sizeof(uint64_t));
+  snapshot->view = *board;
+  snapshot->view.cells = cells;
+  snapshot->view.tilePopulation = population;
+  snapshot->view.tileHash = tileHash;
+  snapshot->view.next = NULL;
+  snapshot->view.tileChanged = NULL;
+  snapshot->view.activeTiles = NULL;
+  snapshot->view.workerAlive = NULL;
+  sim->stats(sim->ctx, &snapshot->stats);
+
+  int shared = atomic_exchange_explicit(&sim->shared, sim->back | SNAPSHOT_FRESH,
+                                        memory_order_acq_rel);
+  sim->back = shared & SNAPSHOT_INDEX;
+  sim->unpublished = 0;
+}
+
+static void addSeconds(struct timespec *time, double seconds) {
+  long long ns = time->tv_sec * 1000000000LL + time->tv_nsec +
+                 (long long)(seconds * 1e9);
+  time->tv_sec = ns / 1000000000;
+  time->tv_nsec = ns % 1000000000;
+}
+
+static int isBefore(const struct timespec *a, const struct timespec *b) {
+  return a->tv_sec < b->tv_sec ||
+         (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static void *simulationThread(void *arg) {
+  Simulation *sim = arg;
+
+  pthread_mutex_lock(&sim->lock);
+  while (!sim->quit) {
+    if (!sim->playing || sim->holders) {
+      // Whatever was stepped last must be visible while paused
+      if (sim->unpublished && !sim->holders)
+        publish(sim);
+      pthread_cond_wait(&sim->wake, &sim->lock);
+      continue;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (sim->interval > 0 && isBefore(&now, &sim->nextStep)) {
+      if (sim->unpublished)
+        publish(sim);
+      pthread_cond_timedwait(&sim->wake, &sim->lock, &sim->nextStep);
+      continue;
+    }
+
+    // Step without the lock, so the interval and play state can change
+    sim->stepping = 1;
+    pthread_mutex_unlock(&sim->lock);
+
+    int generations = sim->step(sim->ctx);
+    sim->unpublished += (generations > 0);
+
+    // Publishing costs a board copy, only worth it once the renderer
+    // took the last snapshot
+    int taken = !(atomic_load_explicit(&sim->shared, memory_order_acquire) &
+                  SNAPSHOT_FRESH);
+    if (generations == 0 || taken)
+      publish(sim);
+
+    pthread_mutex_lock(&sim->lock);
+    sim->stepping = 0;
+    if (generations == 0)
+      sim->playing = 0;
+    sim->nextStep = now;
+    addSeconds(&sim->nextStep, sim->interval);
+    pthread_cond_broadcast(&sim->idle);
+  }
+  pthread_mutex_unlock(&sim->lock);
+
+  return NULL;
+}
+
+Simulation *createSimulation(Board *board, SimulationStepFunc step,
+                             SimulationStatsFunc stats, void *ctx) {
+  Simulation *sim = calloc(1, sizeof(Simulation));
+  if (!sim)
+    return NULL;
+
+  sim->board = board;
+  sim->step = step;
+  sim->stats = stats;
+  sim->ctx = ctx;
+  for (int i = 0; i < 3; i++) {
+    if (!createSnapshot(&sim->snapshots[i], board)) {
+      for (int j = 0; j <= i; j++)
+        destroySnapshot(&sim->snapshots[j]);
+      free(sim);
+      return NULL;
+    }
+  }
+
+  // The board as it is now is the first snapshot
+  sim->front = 0;
+  sim->back = 1;
+  atomic_init(&sim->shared, 2);
+  publish(sim);
+
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_mutex_init(&sim->lock, NULL);
+  pthread_cond_init(&sim->wake, &attr);
+  pthread_cond_init(&sim->idle, NULL);
+  pthread_condattr_destroy(&attr);
+
+  if (pthread_create(&sim->thread, NULL, simulationThread, sim)) {
+    pthread_mutex_destroy(&sim->lock);
+    pthread_cond_destroy(&sim->wake);
+    pthread_cond_destroy(&sim->idle);
+    for (int i = 0; i < 3; i++)
+      destroySnapshot(&sim->snapshots[i]);
+    free(sim);
+    return NULL;
+  }
+
+  return sim;
+}
+
+void destroySimulation(Simulation *sim) {
+  if (!sim)
+    return;
+
+  pthread_mutex_lock(&sim->lock);
+  sim->quit = 1;
+  pthread_cond_signal(&sim->wake);
+  pthread_mutex_unlock(&sim->lock);
+  pthread_join(sim->thread, NULL);
+
+  pthread_mutex_destroy(&sim->lock);
+  pthread_cond_destroy(&sim->wake);
+  pthread_cond_destroy(&sim->idle);
+  for (int i = 0; i < 3; i++)
+    destroySnapshot(&sim->snapshots[i]);
+  free(sim);
+}
+
+void playSimulation(Simulation *sim, int play) {
+  pthread_mutex_lock(&sim->lock);
+  if (play && !sim->playing)
+    clock_gettime(CLOCK_MONOTONIC, &sim->nextStep);
+  sim->playing = play;
+  pthread_cond_signal(&sim->wake);
+  pthread_mutex_unlock(&sim->lock);
+}
+
+int isSimulationPlaying(Simulation *sim) {
+  pthread_mutex_lock(&sim->lock);
+  int playing = sim->playing;
+  pthread_mutex_unlock(&sim->lock);
+
+  return playing;
+}
+
+void setSimulationInterval(Simulation *sim, double interval) {
+  pthread_mutex_lock(&sim->lock);
+  // A shorter interval takes effect right away
+  if (interval < sim->interval)
+    addSeconds(&sim->nextStep, interval - sim->interval);
+  sim->interval = interval;
+  pthread_cond_signal(&sim->wake);
+  pthread_mutex_unlock(&sim->lock);
+}
+
+void lockSimulation(Simulation *sim) {
+  pthread_mutex_lock(&sim->lock);
+  sim->holders++;
+  while (sim->stepping)
+    pthread_cond_wait(&sim->idle, &sim->lock);
+  pthread_mutex_unlock(&sim->lock);
+}
+
+void unlockSimulation(Simulation *sim) {
+  pthread_mutex_lock(&sim->lock);
+  publish(sim);
+  sim->holders--;
+  pthread_cond_signal(&sim->wake);
+  pthread_mutex_unlock(&sim->lock);
+}
+
+const Snapshot *acquireSnapshot(Simulation *sim) {
+  if (atomic_load_explicit(&sim->shared, memory_order_acquire) &
+      SNAPSHOT_FRESH)
+    sim->front = atomic_exchange_explicit(&sim->shared, sim->front,
+                                          memory_order_acq_rel) &
+                 SNAPSHOT_INDEX;
+
+  return &sim->snapshots[sim->front];
+}
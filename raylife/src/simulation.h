@@ -0,0 +1,83 @@
+/*******************************************************************************************
+ *
+ *   Simulation: steps the board on a thread of its own
+ *
+ *   While playing, the simulation thread steps the board at the set interval,
+ *   or as fast as it can with an interval of 0, so the window keeps its frame
+ *   rate whatever the board size. Results are published as snapshots through
+ *   a lock-free triple buffer: the thread fills one copy of the board while
+ *   the renderer reads another, and the third holds the latest completed
+ *   one. A new snapshot is only copied once the renderer took the last one.
+ *
+ *   Anything else that touches the board (edits, engine switches, single
+ *   steps) must happen between lockSimulation() and unlockSimulation().
+ *
+ *******************************************************************************************/
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "board.h"
+#include "hashlife.h"
+#include "history.h"
+#include "plane.h"
+#include "stats.h"
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define SIMULATION_RECENT_STATS 288 // Generations of stats in each snapshot
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct Simulation Simulation;
+
+typedef struct {
+  long long generation;
+  long long period;       // Period the board repeats with, 0 if not found
+  long long periodStart;  // Generation the repeat was found at
+  HashLifeStats hashLife; // Only filled while HashLife runs
+  PlaneStats plane;       // Only filled while the plane runs
+  HistoryStats history;   // Only filled with a history
+  GenerationStats recent[SIMULATION_RECENT_STATS]; // Oldest first
+  int recentCount;
+} SimulationStats;
+
+typedef struct {
+  // Copy of the board, with cells, tile populations and tile hashes of its
+  // own. Only the fields needed to draw it are valid: no back buffer or
+  // tile flags.
+  Board view;
+  SimulationStats stats;
+} Snapshot;
+
+// Steps the board on the simulation thread. Returns the number of
+// generations advanced, or 0 to stop playing.
+typedef int (*SimulationStepFunc)(void *ctx);
+// Fills the stats published with the board, by whoever holds the board
+typedef void (*SimulationStatsFunc)(void *ctx, SimulationStats *stats);
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// Returns NULL on failure. The board must outlive the simulation.
+Simulation *createSimulation(Board *board, SimulationStepFunc step,
+                             SimulationStatsFunc stats, void *ctx);
+void destroySimulation(Simulation *sim);
+
+void playSimulation(Simulation *sim, int play);
+int isSimulationPlaying(Simulation *sim);
+// Seconds between generations while playing, 0 runs as fast as possible
+void setSimulationInterval(Simulation *sim, double interval);
+
+// Waits for the current step to end and keeps the thread off the board
+void lockSimulation(Simulation *sim);
+// Publishes the board as it was left and lets the thread continue
+void unlockSimulation(Simulation *sim);
+
+// Latest published snapshot, valid until the next call. Only one thread
+// may read snapshots.
+const Snapshot *acquireSnapshot(Simulation *sim);
+
+#endif // SIMULATION_H
@@ -0,0 +1,102 @@
+#include "stats.h"
+
+#include <stdlib.h>
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct StatsRing {
+  GenerationStats *entries;
+  int capacity;
+  int start;         // Oldest entry
+  int count;
+  int unwritten;     // Latest entries not written to CSV yet
+  int headerWritten;
+};
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+StatsRing *createStatsRing(int capacity) {
+  StatsRing *ring = calloc(1, sizeof(StatsRing));
+  if (!ring)
+    return NULL;
+
+  ring->capacity = (capacity > 0) ? capacity : STATS_DEFAULT_CAPACITY;
+  ring->entries = malloc(ring->capacity * sizeof(GenerationStats));
+  if (!ring->entries) {
+    free(ring);
+    return NULL;
+  }
+
+  return ring;
+}
+
+void destroyStatsRing(StatsRing *ring) {
+  if (!ring)
+    return;
+
+  free(ring->entries);
+  free(ring);
+}
+
+// Entries not written yet are dropped too, but the CSV header stays written
+void clearStatsRing(StatsRing *ring) {
+  ring->start = 0;
+  ring->count = 0;
+  ring->unwritten = 0;
+}
+
+void pushStats(StatsRing *ring, const GenerationStats *stats) {
+  int slot = ring->start + ring->count;
+  if (slot >= ring->capacity)
+    slot -= ring->capacity;
+
+  ring->entries[slot] = *stats;
+  if (ring->count < ring->capacity)
+    ring->count++;
+  else if (++ring->start == ring->capacity)
+    ring->start = 0;
+  if (ring->unwritten < ring->capacity)
+    ring->unwritten++;
+}
+
+int getStatsCount(const StatsRing *ring) { return ring->count; }
+
+const GenerationStats *getStats(const StatsRing *ring, int i) {
+  int slot = ring->start + i;
+  if (slot >= ring->capacity)
+    slot -= ring->capacity;
+
+  return &ring->entries[slot];
+}
+
+int copyRecentStats(const StatsRing *ring, GenerationStats *stats, int max) {
+  int count = (ring->count < max) ? ring->count : max;
+  int first = ring->count - count;
+
+  for (int i = 0; i < count; i++)
+    stats[i] = *getStats(ring, first + i);
+
+  return count;
+}
+
+int getUnwrittenStats(const StatsRing *ring) { return ring->unwritten; }
+
+int writeStatsCsv(StatsRing *ring, FILE *file) {
+  if (!ring->headerWritten) {
+    fprintf(file, "generation,population,births,deaths,active,step_ms,"
+                  "draw_ms\n");
+    ring->headerWritten = 1;
+  }
+
+  for (int i = ring->count - ring->unwritten; i < ring->count; i++) {
+    const GenerationStats *stats = getStats(ring, i);
+    fprintf(file, "%lld,%lld,%lld,%lld,%d,%.4f,%.4f\n", stats->generation,
+            stats->population, stats->births, stats->deaths, stats->active,
+            stats->stepTime * 1000.0, stats->drawTime * 1000.0);
+  }
+  ring->unwritten = 0;
+
+  return !ferror(file);
+}
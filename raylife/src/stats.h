@@ -0,0 +1,60 @@
+/*******************************************************************************************
+ *
+ *   Stats: per-generation statistics in a fixed-size ring
+ *
+ *   Each step records the population, the cells born and died, the tiles or
+ *   chunks stepped and the time spent stepping and drawing. The ring keeps
+ *   the latest entries and overwrites the oldest, so memory stays the same
+ *   however long the run.
+ *
+ *   Entries are written to CSV files once each: writing whenever the ring
+ *   fills up dumps every generation of a run, in a ring of any size.
+ *
+ *******************************************************************************************/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+//----------------------------------------------------------------------------------
+// Constants Definition
+//----------------------------------------------------------------------------------
+#define STATS_DEFAULT_CAPACITY 4096
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct StatsRing StatsRing;
+
+typedef struct {
+  long long generation;
+  long long population;
+  long long births; // -1 where the engine doesn't count them, like deaths
+  long long deaths;
+  int active;       // Tiles or chunks stepped, -1 for HashLife
+  float stepTime;   // Seconds
+  float drawTime;   // Seconds the last frame took to draw, 0 without a window
+} GenerationStats;
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// Returns NULL on allocation failure
+StatsRing *createStatsRing(int capacity);
+void destroyStatsRing(StatsRing *ring);
+void clearStatsRing(StatsRing *ring);
+void pushStats(StatsRing *ring, const GenerationStats *stats);
+int getStatsCount(const StatsRing *ring);
+// Entry i, from the oldest (0) to the latest (count - 1)
+const GenerationStats *getStats(const StatsRing *ring, int i);
+// Copies up to the latest max entries, oldest first, and returns how many
+int copyRecentStats(const StatsRing *ring, GenerationStats *stats, int max);
+// Entries not written yet. Once it reaches the ring size, the next push
+// overwrites one of them.
+int getUnwrittenStats(const StatsRing *ring);
+// Writes the entries not written yet as CSV lines, after a header line on
+// the first call. Returns 0 on write errors.
+int writeStatsCsv(StatsRing *ring, FILE *file);
+
+#endif // STATS_H
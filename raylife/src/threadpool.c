@@ -0,0 +1,218 @@
+#include "threadpool.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+
+// Remaining task slice of one worker, packed as (end << 32 | begin) so the
+// owner and thieves can both update it with a single compare-and-swap.
+// Aligned to a cache line so workers don't false-share their slices.
+typedef struct {
+  _Alignas(64) _Atomic uint64_t range;
+} WorkerSlice;
+
+typedef struct {
+  ThreadPool *pool;
+  int index;
+} WorkerArgs;
+
+struct ThreadPool {
+  int threads;
+  pthread_t *handles;
+  WorkerArgs *args;
+  WorkerSlice *slices;
+
+  pthread_mutex_t lock;
+  pthread_cond_t start; // Signaled when a new job is published
+  pthread_cond_t done;  // Signaled when the last helper finishes a job
+  unsigned long round;  // Incremented for every job
+  int running;          // Helpers still working on the current job
+  int quit;
+
+  ThreadPoolJob job;
+  void *ctx;
+};
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+static inline uint64_t packRange(uint32_t begin, uint32_t end) {
+  return ((uint64_t)end << 32) | begin;
+}
+
+// Takes the next task from the front of a worker's own slice
+static int popTask(WorkerSlice *slice, int *task) {
+  uint64_t range = atomic_load_explicit(&slice->range, memory_order_relaxed);
+
+  for (;;) {
+    uint32_t begin = (uint32_t)range, end = (uint32_t)(range >> 32);
+    if (begin >= end)
+      return 0;
+    if (atomic_compare_exchange_weak(&slice->range, &range,
+                                     packRange(begin + 1, end))) {
+      *task = (int)begin;
+      return 1;
+    }
+  }
+}
+
+// Moves the upper half of some other worker's slice into our own
+static int stealTasks(ThreadPool *pool, int self) {
+  for (int k = 1; k < pool->threads; k++) {
+    WorkerSlice *victim = &pool->slices[(self + k) % pool->threads];
+    uint64_t range = atomic_load_explicit(&victim->range, memory_order_relaxed);
+
+    for (;;) {
+      uint32_t begin = (uint32_t)range, end = (uint32_t)(range >> 32);
+      if (begin >= end)
+        break;
+
+      uint32_t mid = begin + (end - begin) / 2;
+      if (atomic_compare_exchange_weak(&victim->range, &range,
+                                       packRange(begin, mid))) {
+        atomic_store(&pool->slices[self].range, packRange(mid, end));
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+static void workOnJob(ThreadPool *pool, int self) {
+  int task;
+
+  do {
+    while (popTask(&pool->slices[self], &task))
+      pool->job(pool->ctx, task, self);
+  } while (stealTasks(pool, self));
+}
+
+static void *workerMain(void *arg) {
+  WorkerArgs *args = arg;
+  ThreadPool *pool = args->pool;
+  unsigned long seen = 0;
+
+  pthread_mutex_lock(&pool->lock);
+  for (;;) {
+    while (pool->round == seen && !pool->quit)
+      pthread_cond_wait(&pool->start, &pool->lock);
+    if (pool->quit)
+      break;
+    seen = pool->round;
+    pthread_mutex_unlock(&pool->lock);
+
+    workOnJob(pool, args->index);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->running == 0)
+      pthread_cond_signal(&pool->done);
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  return NULL;
+}
+
+ThreadPool *createThreadPool(int threads) {
+  if (threads < 1)
+    threads = 1;
+
+  ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+  if (!pool)
+    return NULL;
+
+  pool->threads = threads;
+  pool->handles = calloc(threads, sizeof(pthread_t));
+  pool->args = calloc(threads, sizeof(WorkerArgs));
+  pool->slices = aligned_alloc(64, threads * sizeof(WorkerSlice));
+  if (!pool->handles || !pool->args || !pool->slices) {
+    free(pool->handles);
+    free(pool->args);
+    free(pool->slices);
+    free(pool);
+    return NULL;
+  }
+
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+
+  for (int i = 0; i < threads; i++) {
+    atomic_init(&pool->slices[i].range, 0);
+    pool->args[i] = (WorkerArgs){pool, i};
+  }
+
+  // Worker 0 is whoever calls runThreadPool()
+  for (int i = 1; i < threads; i++) {
+    if (pthread_create(&pool->handles[i], NULL, workerMain, &pool->args[i])) {
+      pool->threads = i;
+      break;
+    }
+  }
+
+  return pool;
+}
+
+void destroyThreadPool(ThreadPool *pool) {
+  if (!pool)
+    return;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->quit = 1;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (int i = 1; i < pool->threads; i++)
+    pthread_join(pool->handles[i], NULL);
+
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->done);
+  free(pool->handles);
+  free(pool->args);
+  free(pool->slices);
+  free(pool);
+}
+
+int getThreadPoolSize(const ThreadPool *pool) { return pool ? pool->threads : 1; }
+
+int getDefaultThreadCount(void) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  return (cpus > 0) ? (int)cpus : 1;
+}
+
+void runThreadPool(ThreadPool *pool, int count, ThreadPoolJob job, void *ctx) {
+  if (!pool || pool->threads == 1 || count < 2) {
+    for (int task = 0; task < count; task++)
+      job(ctx, task, 0);
+    return;
+  }
+
+  int threads = pool->threads;
+  for (int i = 0; i < threads; i++) {
+    uint32_t begin = (uint32_t)((long long)count * i / threads);
+    uint32_t end = (uint32_t)((long long)count * (i + 1) / threads);
+    atomic_store(&pool->slices[i].range, packRange(begin, end));
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool->job = job;
+  pool->ctx = ctx;
+  pool->running = threads - 1;
+  pool->round++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  workOnJob(pool, 0);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->running > 0)
+    pthread_cond_wait(&pool->done, &pool->lock);
+  pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,35 @@
+/*******************************************************************************************
+ *
+ *   ThreadPool: persistent worker threads running parallel-for jobs
+ *
+ *   Every job is a range of task indices. Each worker starts with an equal
+ *   contiguous slice of the range and, when it runs dry, steals the upper half
+ *   of another worker's remaining slice. The calling thread takes part as
+ *   worker 0, so a pool of N threads spawns N - 1 helpers.
+ *
+ *******************************************************************************************/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct ThreadPool ThreadPool;
+
+// Runs one task. `worker` is in [0, threads) and is stable for the whole task,
+// so jobs can accumulate per-worker results without atomics.
+typedef void (*ThreadPoolJob)(void *ctx, int task, int worker);
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+ThreadPool *createThreadPool(int threads); // Returns NULL on failure
+void destroyThreadPool(ThreadPool *pool);
+int getThreadPoolSize(const ThreadPool *pool);
+int getDefaultThreadCount(void); // Number of online CPUs
+
+// Runs job for every task in [0, count) and returns once all of them are done
+void runThreadPool(ThreadPool *pool, int count, ThreadPoolJob job, void *ctx);
+
+#endif // THREADPOOL_H
@@ -12,12 +12,26 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include <stdlib.h>     // Required for: calloc(), malloc(), free(), abs(), atoi(), strtoul()
+#include <string.h>     // Required for: memset()
 #include <math.h>       // Required for:
 
 #if defined(PLATFORM_WEB)
     #include <emscripten/emscripten.h>
 #endif
 
+// Assets files are read and decoded on a background thread, while logo screen is shown
+// NOTE: Requires POSIX threads and C11 atomics, not available on web (without pthreads) or MSVC,
+// assets are loaded before first frame on those platforms
+#if !defined(PLATFORM_WEB) && !defined(_MSC_VER)
+    #define ASSETS_LOADER_THREAD
+#endif
+
+#if defined(ASSETS_LOADER_THREAD)
+    #include <pthread.h>        // Required for: pthread_create(), pthread_join()
+    #include <stdatomic.h>      // Required for: atomic_int
+#endif
+
 // Define the 4 basic GameBoy green colors
 #define GB_GREEN01 (Color){ 155, 188, 15, 255 }
 #define GB_GREEN02 (Color){ 110, 150, 27, 255 }
@@ -44,11 +58,74 @@
 
 #define PLAYER_MOVEMENT_SENSITIVITY         16.0f
 
+// Gameplay fixed timestep
+#define GAMEPLAY_TICK_RATE                    60    // Gameplay ticks per second, independent of render rate
+#define GAMEPLAY_TICK_TIME      (1.0f/GAMEPLAY_TICK_RATE)
+#define GAMEPLAY_MAX_FRAME_TIME             0.25f   // Maximum frame time run as gameplay ticks (in seconds)
+
+#define PLAYER_COLLISION_RADIUS              0.1f    // Player is modelled as a cylinder for collision
+
+// Generated maze and map chunks
+#define MAZE_MAX_SIZE                       4096    // Maximum generated maze size (in maze cells per side)
+
+#define MAP_CHUNK_SIZE                        32    // Map chunk size (in map cells per side)
+#define MAP_REGION_SIZE                        8    // Map region size (in map cells per side), every region is a separate model
+#define MAP_CHUNK_REGIONS   (MAP_CHUNK_SIZE/MAP_REGION_SIZE)    // Regions per chunk side
+#define MAP_CHUNK_LOAD_RADIUS                  1    // Chunks around player chunk to be loaded (in chunks)
+#define MAX_MAP_CHUNKS                        16    // Maximum map chunks loaded at the same time
+
+#define MAP_PVS_RANGE                          4    // Potentially visible regions range around cell region (in regions)
+#define MAP_PVS_RAYS                         256    // Rays cast from every cell sample point to compute the cell PVS
+#define MAP_PVS_BYTES       (((2*MAP_PVS_RANGE + 1)*(2*MAP_PVS_RANGE + 1) + 7)/8)  // Cell PVS size, one bit per region in range
+#define MAP_PVS_CELLS_PER_TICK                16    // Chunk cells PVS generated per gameplay tick
+
+#define MAP_TILES                              4    // Map texture atlas tiles, one mesh per tile
+
+#define EXIT_DISTANCES_TIME_BUDGET         0.002    // Exit distances field computation time per frame on menus and per gameplay tick (seconds)
+#define EXIT_DISTANCES_BATCH_CELLS          4096    // Exit distances field cells computed between time budget checks
+#define HINT_CELLS_AHEAD                       3    // Hint arrow points to the path cell this far ahead
+
+#define MINIMAP_SIZE                          32    // Minimap window size around player (in map cells), power of two to wrap around texture
+#define MINIMAP_REVEAL_RANGE                   6    // Minimap cells revealed along straight corridors from player (in map cells)
+
 //----------------------------------------------------------------------------------
 // Enums and struct data types
 //----------------------------------------------------------------------------------
 typedef enum { LOGO = 0, TITLE, CREDITS, GAMEPLAY, ENDING } GameScreen;
 
+// Asset types loaded in background
+typedef enum { ASSET_TEXTURE = 0, ASSET_FONT, ASSET_SOUND, ASSET_MUSIC } AssetType;
+
+// Asset loaded in background, decoded by loader thread and uploaded on main thread
+typedef struct Asset {
+    const char *fileName;       // Asset file name
+    AssetType type;             // Asset type
+    void *target;               // Asset variable to load (Texture2D, Font, Sound or Music, depending on type)
+    unsigned char *fileData;    // File data, only kept for music (streamed from memory)
+    int fileSize;               // File data size
+    Image image;                // Decoded image (textures and font)
+    Wave wave;                  // Decoded wave (sounds)
+    Music music;                // Music stream (music)
+} Asset;
+
+// Map texture atlas tiles (2x2 atlas)
+typedef enum {
+    MAP_TILE_WALL_A = 0,    // Walls front and right faces
+    MAP_TILE_WALL_B,        // Walls back and left faces
+    MAP_TILE_FLOOR,
+    MAP_TILE_CEILING
+} MapTile;
+
+// Map chunk, a square area of the map loaded on demand, split in regions models
+typedef struct MapChunk {
+    int x;                  // Chunk position in chunks, X
+    int y;                  // Chunk position in chunks, Y
+    bool loaded;            // Chunk is loaded (slot in use)
+    Model regions[MAP_CHUNK_REGIONS*MAP_CHUNK_REGIONS];     // Chunk regions models, generated from map walls
+    unsigned char *pvs;     // Potentially visible regions of every chunk cell (MAP_PVS_BYTES per cell)
+    int pvsCells;           // Chunk cells with PVS generated, in chunk cells order
+} MapChunk;
+
 //----------------------------------------------------------------------------------
 // Module Variables Definition (local)
 //----------------------------------------------------------------------------------
@@ -63,6 +140,10 @@ static int titleState = 0;
 static int optionSelect = 0;       // Main menu option selection
 
 static Camera camera = { 0 };
+static Vector3 previousCameraPosition = { 0 };     // Camera position on previous gameplay tick, for interpolation
+static float gameplayTickAccumulator = 0.0f;    // Time elapsed not run as gameplay ticks yet
+
+static int targetFPS = 60;          // Render rate, 0 for uncapped
 
 static Vector3 mapPosition = { 0.0f, 0.0f, 0.0f };      // Set map position
 static Vector3 playerPosition = { 0 };
@@ -70,6 +151,17 @@ static Vector3 playerPosition = { 0 };
 static int exitCellX = 19;
 static int exitCellY = 9;
 
+static unsigned char *minimapExplored = NULL;   // Map cells explored bitset, one bit per map cell (1 = revealed on minimap)
+static Image imMinimap = { 0 };                 // Minimap window image (CPU), map cell (x, y) is pixel (x%MINIMAP_SIZE, y%MINIMAP_SIZE)
+static int minimapX = 0;                        // Minimap window origin (in map cells)
+static int minimapY = 0;
+
+static unsigned char *exitDistances = NULL;     // Distance to exit modulo 3 of every map cell, 2 bits per cell (3: wall or not reached yet)
+static int *exitQueue = NULL;                   // Exit distances BFS queue (cells indices)
+static int exitQueueStart = 0;
+static int exitQueueEnd = 0;
+static int exitQueueCapacity = 0;
+
 static float currentGamepadAxisValue[8] = { 0 };
 static float previousGamepadAxisValue[8] = { 0 };
 
@@ -84,8 +176,15 @@ static int stepFrameCount = 0;
 
 static bool showInGameMenu = false;
 static bool showMinimapDebug = false;
-
-static Color *mapPixels = 0;
+static bool showDebugInfo = false;
+static bool showHint = false;
+
+static unsigned char *mapWalls = NULL;     // Map walls bitset, one bit per map cell (1 = wall)
+static int mapWidth = 0;
+static int mapHeight = 0;
+static MapChunk mapChunks[MAX_MAP_CHUNKS] = { 0 };     // Map chunks slots, loaded around player
+static int mapTrianglesLoaded = 0;      // Map triangles in loaded chunks
+static int mapTrianglesDrawn = 0;       // Map triangles drawn last frame
 static int playerCellX = 0;
 static int playerCellY = 0;
 
@@ -102,8 +201,8 @@ static Texture2D texTitleShadow = { 0 };
 static Texture2D texTitle3d = { 0 };
 static Texture2D texTitle3dShadow = { 0 };
 static Texture2D texTitleLogo = { 0 };
-static Texture2D texMap = { 0 };
-static Texture2D texMapAtlas = { 0 };
+static Texture2D texMinimap = { 0 };      // Minimap window texture, patched from minimap image
+static Texture2D texMapTiles[MAP_TILES] = { 0 };     // Map texture atlas tiles, repeated along map quads
 
 static Texture2D texGpiCase = { 0 };
 
@@ -123,7 +222,42 @@ static Music musicCredits = { 0 };
 
 static Sound fxVoice[4] = { 0 };
 
-static Model model = { 0 };
+// Assets loaded in background, in loading order
+static Asset assets[] = {
+    { "resources/logo.png", ASSET_TEXTURE, &texLogo },
+    { "resources/audio/logo.wav", ASSET_SOUND, &fxLogo },
+    { "resources/title.png", ASSET_TEXTURE, &texTitle },
+    { "resources/title_shadow.png", ASSET_TEXTURE, &texTitleShadow },
+    { "resources/title_3d.png", ASSET_TEXTURE, &texTitle3d },
+    { "resources/title_3d_shadow.png", ASSET_TEXTURE, &texTitle3dShadow },
+    { "resources/title_raylib_logo.png", ASSET_TEXTURE, &texTitleLogo },
+    { "resources/gpi_case_front.png", ASSET_TEXTURE, &texGpiCase },
+    { "resources/alpha_beta.png", ASSET_FONT, &font },
+    { "resources/audio/menu_move.wav", ASSET_SOUND, &fxMenuMove },
+    { "resources/audio/menu_select.wav", ASSET_SOUND, &fxMenuSelect },
+    { "resources/audio/pause.wav", ASSET_SOUND, &fxPause },
+    { "resources/audio/title_rocks.wav", ASSET_SOUND, &fxTitleRocks },
+    { "resources/audio/step.wav", ASSET_SOUND, &fxStep },
+    { "resources/audio/ending.wav", ASSET_SOUND, &fxEnding },
+    { "resources/audio/music_title.mp3", ASSET_MUSIC, &musicTitle },
+    { "resources/audio/music_gameplay.mp3", ASSET_MUSIC, &musicGameplay },
+    { "resources/audio/music_credits.mp3", ASSET_MUSIC, &musicCredits },
+    { "resources/audio/voice_hello.wav", ASSET_SOUND, &fxVoice[0] },
+    { "resources/audio/voice_im_lost.wav", ASSET_SOUND, &fxVoice[1] },
+    { "resources/audio/voice_anyone_there.wav", ASSET_SOUND, &fxVoice[2] },
+    { "resources/audio/voice_can_you_hear_me.wav", ASSET_SOUND, &fxVoice[3] },
+};
+
+#define ASSETS_COUNT    (int)(sizeof(assets)/sizeof(Asset))
+
+#if defined(ASSETS_LOADER_THREAD)
+static pthread_t assetsLoader = { 0 };      // Assets loader thread
+static bool assetsLoaderStarted = false;    // Assets loader thread was created (to be joined)
+static atomic_int assetsDecoded = 0;        // Assets decoded by loader thread (written by loader, read by main thread)
+#else
+static int assetsDecoded = 0;
+#endif
+static int assetsUploaded = 0;              // Assets uploaded on main thread, ready to be used
 
 // Render texture to draw full screen, enables screen scaling
 static RenderTexture2D screenTarget = { 0 };
@@ -132,53 +266,71 @@ static RenderTexture2D screenTarget = { 0 };
 // Module Functions Declaration (local)
 //----------------------------------------------------------------------------------
 static void UpdateDrawFrame(void);              // Update and Draw one frame
+static void UpdateGameplayTick(void);           // Update gameplay tick (fixed rate)
 static void UpdateCameraCustom(Camera *camera); // Update camera custom (first person)
 
 static bool IsGamepadAxisAsButtonPressed(int gamepad, int axis, bool positiveAxis);
 
+static unsigned char *LoadMapWalls(Image map);          // Load walls bitset from map image (white pixels)
+static bool IsMapWall(int x, int y);                    // Check if map cell is a wall (cells out of map are)
+static bool CheckCollisionMapWalls(Vector2 position, float radius);  // Check collision with walls around position
+static unsigned char *GenMazeWalls(int width, int height, unsigned int seed);   // Generate maze walls bitset (recursive backtracker)
+static Model LoadMapRegionModel(int x, int y, int width, int height);   // Load map region model, walls faces merged into bigger quads
+static void AddMapQuad(Mesh *mesh, Vector3 corner, Vector3 right, Vector3 down);    // Add quad to map mesh
+static int GetMapRegionCubicmapQuads(int x, int y, int width, int height);  // Get quads GenMeshCubicmap() would generate for a map region
+
+static int GenMapChunkPVS(MapChunk *chunk, int maxCells);       // Generate potentially visible regions of next chunk cells, up to maxCells
+static void UpdateMapChunksPVS(int cellX, int cellY, int maxCells);    // Update loaded map chunks PVS generation, up to maxCells cells
+static void CastMapPVSRay(unsigned char *pvs, int cellX, int cellY, Vector2 origin, float angle);   // Cast ray from cell, marking regions in cell PVS
+static bool IsMapRegionVisible(const unsigned char *pvs, int dx, int dy);  // Check if region is in cell PVS
+static const unsigned char *GetMapCellPVS(int cellX, int cellY);    // Get map cell PVS, from the loaded chunk containing it
+
+static void SetMapExit(int x, int y);                   // Set map exit cell, restarting exit distances field computation
+static bool UpdateExitDistances(double maxTime);        // Update exit distances field (BFS from exit), for up to maxTime seconds
+static int GetExitDistanceCode(int x, int y);           // Get cell distance to exit modulo 3 (3: wall or not reached yet)
+static bool GetExitStep(int x, int y, int *nextX, int *nextY);  // Get next cell towards exit from cell (one step closer)
+
+static void ResetMinimap(int cellX, int cellY);         // Reset minimap fog of war, with window around map cell
+static void UpdateMinimap(int cellX, int cellY);        // Update minimap, scrolling window to map cell and revealing cells around it
+static void RevealMinimapCell(int x, int y);            // Reveal map cell on minimap, patching its texel (if inside window)
+static void PatchMinimapColumn(int x);                  // Patch minimap texture column of map cells column (window rows)
+static void PatchMinimapRow(int y);                     // Patch minimap texture row of map cells row (window columns)
+static Color GetMinimapCellColor(int x, int y);         // Get minimap color of map cell (fog for cells not explored)
+static bool IsMinimapCellExplored(int x, int y);        // Check if map cell is explored (revealed on minimap)
+static int ClampMinimapOrigin(int origin, int mapSize); // Clamp minimap window origin to map (in map cells)
+
+static void UpdateMapChunks(int cellX, int cellY, int maxLoads);   // Update map chunks loaded around map cell
+static void UnloadMapChunk(MapChunk *chunk);            // Unload map chunk regions models and PVS
+static void UnloadMapChunks(void);                      // Unload all map chunks
+
+static void *LoadAssetsData(void *arg);                 // Load assets data, reading and decoding files (run by assets loader thread)
+static void UploadAssets(void);                         // Upload assets decoded by loader thread (GPU textures, audio sounds)
+
 //----------------------------------------------------------------------------------
 // Program main entry point
 //----------------------------------------------------------------------------------
-int main()
+int main(int argc, char *argv[])
 {
     // Initialization
     //--------------------------------------------------------------------------------------
     SetConfigFlags(FLAG_MSAA_4X_HINT | FLAG_WINDOW_TRANSPARENT);
     InitWindow(screenWidth, screenHeight, "RETRO MAZE 3D [GGJ 2021]");
 
-    // Textures loading
-    texLogo = LoadTexture("resources/logo.png");
-    texTitle = LoadTexture("resources/title.png");
-    texTitleShadow = LoadTexture("resources/title_shadow.png");
-    texTitle3d = LoadTexture("resources/title_3d.png");
-    texTitle3dShadow = LoadTexture("resources/title_3d_shadow.png");
-    texTitleLogo = LoadTexture("resources/title_raylib_logo.png");
-
-    texGpiCase = LoadTexture("resources/gpi_case_front.png");
-
-    // Text Font loading
-    font = LoadFont("resources/alpha_beta.png");
-
     InitAudioDevice();
 
-    // Audio loading
-    fxLogo = LoadSound("resources/audio/logo.wav");
-    fxMenuMove = LoadSound("resources/audio/menu_move.wav");
-    fxMenuSelect = LoadSound("resources/audio/menu_select.wav");
-    fxPause = LoadSound("resources/audio/pause.wav");
-    fxTitleRocks = LoadSound("resources/audio/title_rocks.wav");
-    fxStep = LoadSound("resources/audio/step.wav");
-    fxEnding = LoadSound("resources/audio/ending.wav");
-
-    musicTitle = LoadMusicStream("resources/audio/music_title.mp3");
-    musicGameplay = LoadMusicStream("resources/audio/music_gameplay.mp3");
-    musicCredits = LoadMusicStream("resources/audio/music_credits.mp3");
-    musicCredits.looping = false;
-
-    fxVoice[0] = LoadSound("resources/audio/voice_hello.wav");
-    fxVoice[1] = LoadSound("resources/audio/voice_im_lost.wav");
-    fxVoice[2] = LoadSound("resources/audio/voice_anyone_there.wav");
-    fxVoice[3] = LoadSound("resources/audio/voice_can_you_hear_me.wav");
+    // Textures, font, sounds and music loading
+    // NOTE: Files are read and decoded by assets loader thread, GPU textures and sounds
+    // are created on main thread while logo screen is shown (see UploadAssets())
+#if defined(ASSETS_LOADER_THREAD)
+    if (pthread_create(&assetsLoader, NULL, LoadAssetsData, NULL) == 0) assetsLoaderStarted = true;
+    else
+    {
+        TraceLog(LOG_WARNING, "ASSETS: Loader thread could not be created, loading assets on main thread");
+        LoadAssetsData(NULL);
+    }
+#else
+    LoadAssetsData(NULL);
+#endif
 
     // Define the camera to look into our 3d world
     // WARNING: Camera target is actually controlled by cameraAngle, so initial value is ignored...
@@ -188,23 +340,60 @@ int main()
     camera.fovy = 45.0f;                                // Camera field-of-view Y
     camera.projection = CAMERA_PERSPECTIVE;                   // Camera mode type
 
-    playerPosition = camera.position;   // Initial player position
+    // Load map data (walls and texture)
+    // NOTE: Map models are generated by chunks around the player while playing,
+    // every face type is mapped to one tile of the texture atlas, loaded as a separate
+    // texture so it can be repeated along merged faces
+    Image imMapAtlas = LoadImage("resources/cubicmap_atlas.png");   // Load map texture atlas image (RAM)
+
+    for (int i = 0; i < MAP_TILES; i++)
+    {
+        Image imTile = ImageFromImage(imMapAtlas, (Rectangle){ (i%2)*imMapAtlas.width/2.0f, (i/2)*imMapAtlas.height/2.0f, imMapAtlas.width/2.0f, imMapAtlas.height/2.0f });
+        texMapTiles[i] = LoadTextureFromImage(imTile);
+        SetTextureWrap(texMapTiles[i], TEXTURE_WRAP_REPEAT);
+        UnloadImage(imTile);
+    }
+
+    UnloadImage(imMapAtlas);
 
-    // Load map data (model anf texture)
-    // NOTE: By default each cube is mapped to one part of texture atlas
-    Image imMap = LoadImage("resources/game_map.png");  // Load texMap image (RAM)
-    Mesh mesh = GenMeshCubicmap(imMap, (Vector3){ 1.0f, 1.0f, 1.0f });
-    model = LoadModelFromMesh(mesh);                    // Load generated mesh into a model
-    texMapAtlas = LoadTexture("resources/cubicmap_atlas.png");      // Load map texture
-    model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = texMapAtlas;     // Set map diffuse texture
-    mapPixels = LoadImageColors(imMap); // Get map image data to be used for collision detection
+    if (argc > 1)
+    {
+        // Generate a random maze: retro_maze_3d <maze_size> [seed]
+        int mazeSize = atoi(argv[1]);
+        unsigned int mazeSeed = (argc > 2)? (unsigned int)strtoul(argv[2], NULL, 10) : 0;
+
+        if (mazeSize < 2) mazeSize = 2;
+        else if (mazeSize > MAZE_MAX_SIZE) mazeSize = MAZE_MAX_SIZE;
+
+        mapWalls = GenMazeWalls(mazeSize, mazeSize, mazeSeed);
+
+        // Start at first maze corner, exit at the opposite one
+        camera.position = (Vector3){ mapPosition.x + 1.0f, 0.3f, mapPosition.z + 1.0f };
+        camera.target = (Vector3){ mapPosition.x + 2.0f, 0.3f, mapPosition.z + 2.0f };
+        exitCellX = mapWidth - 2;
+        exitCellY = mapHeight - 2;
+    }
+    else
+    {
+        Image imMap = LoadImage("resources/game_map.png");  // Load map image (RAM)
+        mapWalls = LoadMapWalls(imMap);     // Get map walls to be used for collision detection
+        UnloadImage(imMap);                 // Unload image from RAM (image not required any more)
+    }
+
+    playerPosition = camera.position;   // Initial player position
 
-    // Convert image to custom GB colors for minimap usage
-    ImageColorReplace(&imMap, WHITE, GB_GREEN03);
-    ImageColorReplace(&imMap, BLACK, GB_GREEN02);
-    texMap = LoadTextureFromImage(imMap);
+    // Set exit for exit distances field, used for hints
+    // NOTE: Field is computed a few cells per frame while on logo and title screens,
+    // hints are not available until cells around player are reached
+    SetMapExit(exitCellX, exitCellY);
 
-    UnloadImage(imMap);                 // Unload image from RAM (image not required any more)
+    // Load minimap, only cells explored by player are revealed
+    // NOTE: Minimap image and texture only hold a window around player, wrapping around,
+    // so they keep the same size for any map size
+    minimapExplored = (unsigned char *)calloc((mapWidth*mapHeight + 7)/8, 1);
+    imMinimap = GenImageColor(MINIMAP_SIZE, MINIMAP_SIZE, GB_GREEN01);
+    texMinimap = LoadTextureFromImage(imMinimap);
+    SetTextureWrap(texMinimap, TEXTURE_WRAP_REPEAT);
 
     // Load render texture to draw game on it, it could be useful for scaling
     // NOTE: If screen is scaled, mouse input should be scaled proportionally
@@ -215,7 +404,7 @@ int main()
     emscripten_set_main_loop(UpdateDrawFrame, 60, 1);
 #else
     DisableCursor();
-    SetTargetFPS(60);   // Set our game to run at 60 frames-per-second
+    SetTargetFPS(60);           // Set our game to run at 60 frames-per-second (gameplay renders at targetFPS)
     //--------------------------------------------------------------------------------------
 
     // Main game loop
@@ -227,7 +416,16 @@ int main()
 
     // De-Initialization
     //--------------------------------------------------------------------------------------
-    UnloadImageColors(mapPixels);   // Unload color array
+#if defined(ASSETS_LOADER_THREAD)
+    if (assetsLoaderStarted) pthread_join(assetsLoader, NULL);  // Wait for assets loader thread, in case game is closed while loading
+#endif
+    UploadAssets();                 // Upload remaining assets (if any), to be unloaded with all the others
+
+    free(mapWalls);                 // Unload map walls bitset
+    UnloadImage(imMinimap);         // Unload minimap image
+    free(minimapExplored);          // Unload minimap explored cells bitset
+    free(exitDistances);            // Unload exit distances field
+    free(exitQueue);
 
     UnloadRenderTexture(screenTarget);
 
@@ -238,13 +436,13 @@ int main()
     UnloadTexture(texTitle3d);
     UnloadTexture(texTitle3dShadow);
     UnloadTexture(texTitleLogo);
-    UnloadTexture(texMap);          // Unload map texture
-    UnloadTexture(texMapAtlas);     // Unload map atlas texture
+    UnloadTexture(texMinimap);      // Unload minimap texture
+    for (int i = 0; i < MAP_TILES; i++) UnloadTexture(texMapTiles[i]);  // Unload map tiles textures
     UnloadTexture(texGpiCase);
 
     UnloadFont(font);               // Unload fonts
 
-    UnloadModel(model);             // Unload map model
+    UnloadMapChunks();              // Unload map chunks models
 
     // Unload sounds
     UnloadSound(fxLogo);
@@ -259,6 +457,9 @@ int main()
     UnloadMusicStream(musicGameplay);
     UnloadMusicStream(musicCredits);
 
+    // Unload music file data, music is streamed from memory
+    for (int i = 0; i < ASSETS_COUNT; i++) UnloadFileData(assets[i].fileData);
+
     for (int i = 0; i < 4; i++) UnloadSound(fxVoice[i]);
 
     CloseAudioDevice();
@@ -285,6 +486,9 @@ static void UpdateDrawFrame(void)
         case LOGO:
         {
             // Update LOGO screen
+            UploadAssets();         // Upload assets decoded by loader thread (if any)
+            UpdateExitDistances(EXIT_DISTANCES_TIME_BUDGET);    // Compute exit distances (if not complete)
+
             framesCounter++;
 
             // Logo moving down logic (animation and sound playing)
@@ -292,11 +496,14 @@ static void UpdateDrawFrame(void)
             if (elementPositionY == (screenHeight/2 - 64 - 1)) PlaySound(fxLogo);
             if (elementPositionY > (screenHeight/2 - 64)) elementPositionY = screenHeight/2 - 64;
 
-            if (framesCounter > 300)
+            // NOTE: Logo screen is kept until all assets are loaded
+            if ((framesCounter > 300) && (assetsUploaded == ASSETS_COUNT))
             {
                 framesCounter = 0;
                 currentScreen = TITLE;
 
+                musicCredits.looping = false;
+
                 // NOTE: elementPositionY is reused for title animation
                 elementPositionY = -texTitle.width;
 
@@ -307,6 +514,8 @@ static void UpdateDrawFrame(void)
         } break;
         case TITLE:
         {
+            UpdateExitDistances(EXIT_DISTANCES_TIME_BUDGET);    // Compute exit distances (if not complete)
+
             UpdateMusicStream(musicTitle);
 
             framesCounter++;
@@ -346,9 +555,17 @@ static void UpdateDrawFrame(void)
                 if (optionSelect == 0)
                 {
                     currentScreen = GAMEPLAY;        // Gameplay screen
+                    SetTargetFPS(targetFPS);         // Gameplay render rate (F2), ticks run at GAMEPLAY_TICK_RATE
+
+                    camera.position = playerPosition;
+                    previousCameraPosition = camera.position;
+                    gameplayTickAccumulator = 0.0f;
 
-                    camera.position = (Vector3){ 2.5f, 0.3f, 23.5f };
-                    playerPosition = camera.position;
+                    // Load map chunks around player before first gameplay frame
+                    UpdateMapChunks((int)(playerPosition.x - mapPosition.x + 0.5f), (int)(playerPosition.z - mapPosition.z + 0.5f), MAX_MAP_CHUNKS);
+                    UpdateMapChunksPVS((int)(playerPosition.x - mapPosition.x + 0.5f), (int)(playerPosition.z - mapPosition.z + 0.5f), MAP_CHUNK_SIZE*MAP_CHUNK_SIZE);
+
+                    ResetMinimap((int)(playerPosition.x - mapPosition.x + 0.5f), (int)(playerPosition.z - mapPosition.z + 0.5f));
 
                     StopMusicStream(musicTitle);
                     PlayMusicStream(musicGameplay);
@@ -382,76 +599,37 @@ static void UpdateDrawFrame(void)
             // In-game minimap
             if (IsKeyPressed(KEY_M) || IsGamepadButtonPressed(0, GPICASE_BUTTON_SELECT)) showMinimapDebug = !showMinimapDebug;
 
+            // In-game hint (path to exit)
+            if (IsKeyPressed(KEY_H) || IsGamepadButtonPressed(0, GPICASE_BUTTON_Y)) showHint = !showHint;
+
+            // In-game debug info
+            if (IsKeyPressed(KEY_F1)) showDebugInfo = !showDebugInfo;
+
+            // Render rate switching: 60 fps, 30 fps, uncapped
+            if (IsKeyPressed(KEY_F2))
+            {
+                targetFPS = (targetFPS == 60)? 30 : (targetFPS == 30)? 0 : 60;
+                SetTargetFPS(targetFPS);
+            }
+
             if (!showInGameMenu)    // Pause menu
             {
                 // In game voices playing logic
                 if (IsKeyPressed(KEY_V) || IsGamepadButtonPressed(0, GPICASE_BUTTON_X)) PlaySound(fxVoice[GetRandomValue(0, 3)]);
 
-                Vector3 oldCamPos = camera.position;    // Store old camera position (to restore in case of collision)
-
-                UpdateCameraCustom(&camera);      // Update camera
-
-                // Check player collision (we simplify to 2D collision detection)
-                Vector2 playerPos = { camera.position.x, camera.position.z };
-                float playerRadius = 0.1f;  // Collision radius (player is modelled as a cilinder for collision)
-
-                playerCellX = (int)(playerPos.x - mapPosition.x + 0.5f);
-                playerCellY = (int)(playerPos.y - mapPosition.z + 0.5f);
-
-                // Out-of-limits security check
-                if (playerCellX < 0) playerCellX = 0;
-                else if (playerCellX >= texMap.width) playerCellX = texMap.width - 1;
-
-                if (playerCellY < 0) playerCellY = 0;
-                else if (playerCellY >= texMap.height) playerCellY = texMap.height - 1;
-
-                // Check map collisions using image data and player position
-                // TODO: Improvement: Just check player surrounding cells for collision
-                for (int y = 0; y < texMap.height; y++)
-                {
-                    for (int x = 0; x < texMap.width; x++)
-                    {
-                        if ((mapPixels[y*texMap.width + x].r == 255) &&       // Collision: white pixel, only check R channel
-                            (CheckCollisionCircleRec(playerPos, playerRadius,
-                            (Rectangle){ mapPosition.x - 0.5f + x*1.0f, mapPosition.z - 0.5f + y*1.0f, 1.0f, 1.0f })))
-                        {
-                            // Collision detected, reset camera position
-                            camera.position = oldCamPos;
-                        }
-                    }
-                }
-
-                // Check ending condition: reach destination
-                if ((playerCellX == exitCellX) && (playerCellY == exitCellY))
-                {
-                    currentScreen = ENDING;
-                    PlaySound(fxEnding);
-                    endingResult = 1;           // Player wins
-
-                    StopMusicStream(musicGameplay);
-                }
+                UpdateCameraCustom(&camera);      // Update camera (look around)
 
-                // Check ending condition: time limit
-                framesCounter++;
-                if (framesCounter == 60)
-                {
-                    timeLevelSeconds--;
-                    framesCounter = 0;
-                    if (timeLevelSeconds == 0)
-                    {
-                        currentScreen = ENDING;
-                        PlaySound(fxEnding);
+                // Run gameplay ticks for the time elapsed, at a fixed rate independent of render rate
+                // NOTE: Frame time is limited to avoid running lots of ticks after a long stall
+                float frameTime = GetFrameTime();
+                if (frameTime > GAMEPLAY_MAX_FRAME_TIME) frameTime = GAMEPLAY_MAX_FRAME_TIME;
 
-                        StopMusicStream(musicGameplay);
-                    }
-                }
+                gameplayTickAccumulator += frameTime;
 
-                // Check ending condition: stamina level
-                if (staminaLevel < 0.0f)
+                while ((gameplayTickAccumulator >= GAMEPLAY_TICK_TIME) && (currentScreen == GAMEPLAY))
                 {
-                    currentScreen = ENDING;
-                    PlaySound(fxEnding);
-                    StopMusicStream(musicGameplay);
+                    UpdateGameplayTick();
+                    gameplayTickAccumulator -= GAMEPLAY_TICK_TIME;
                 }
             }
             else
@@ -488,18 +666,8 @@ static void UpdateDrawFrame(void)
                 }
             }
 
-            // Steps sounds
-            if (playerMoving)
-            {
-                staminaLevel -= 0.01f;
-                stepFrameCount++;
-
-                if (stepFrameCount%20 == 0)
-                {
-                    SetSoundPitch(fxStep, (float)GetRandomValue(80, 120)/100.0f);
-                    PlaySound(fxStep);
-                }
-            }
+            // NOTE: Other screens animate per frame, so they run at 60 fps
+            if (currentScreen != GAMEPLAY) SetTargetFPS(60);
 
         } break;
         case CREDITS:
@@ -573,6 +741,13 @@ static void UpdateDrawFrame(void)
                 // Draw LOGO screen
                 DrawTexture(texLogo, screenWidth/2 - 64, elementPositionY, WHITE);
 
+                // Draw assets loading progress bar
+                if (assetsUploaded < ASSETS_COUNT)
+                {
+                    DrawRectangleLines(screenWidth/2 - 64, screenHeight - 40, 128, 8, GB_GREEN03);
+                    DrawRectangle(screenWidth/2 - 64 + 2, screenHeight - 40 + 2, 124*assetsUploaded/ASSETS_COUNT, 4, GB_GREEN02);
+                }
+
             } break;
             case TITLE:
             {
@@ -604,8 +779,33 @@ static void UpdateDrawFrame(void)
             } break;
             case GAMEPLAY:
             {
-                BeginMode3D(camera);
-                    DrawModel(model, mapPosition, 1.0f, WHITE);     // Draw maze map
+                // Camera is drawn interpolated between the last two gameplay ticks positions,
+                // by the time elapsed since last tick, so movement looks smooth at any render rate
+                Camera renderCamera = camera;
+                renderCamera.position = Vector3Lerp(previousCameraPosition, camera.position, gameplayTickAccumulator/GAMEPLAY_TICK_TIME);
+                renderCamera.target = Vector3Add(camera.target, Vector3Subtract(renderCamera.position, camera.position));
+
+                BeginMode3D(renderCamera);
+                    // Draw maze map regions, only the potentially visible from player cell
+                    // NOTE: If player cell PVS is not available, all loaded regions are drawn
+                    const unsigned char *pvs = GetMapCellPVS(playerCellX, playerCellY);
+                    mapTrianglesDrawn = 0;
+
+                    for (int i = 0; i < MAX_MAP_CHUNKS; i++)
+                    {
+                        if (!mapChunks[i].loaded) continue;
+
+                        for (int r = 0; r < MAP_CHUNK_REGIONS*MAP_CHUNK_REGIONS; r++)
+                        {
+                            int regionX = mapChunks[i].x*MAP_CHUNK_REGIONS + r%MAP_CHUNK_REGIONS;
+                            int regionY = mapChunks[i].y*MAP_CHUNK_REGIONS + r/MAP_CHUNK_REGIONS;
+
+                            if ((pvs != NULL) && !IsMapRegionVisible(pvs, regionX - playerCellX/MAP_REGION_SIZE, regionY - playerCellY/MAP_REGION_SIZE)) continue;
+
+                            DrawModel(mapChunks[i].regions[r], (Vector3){ mapPosition.x + regionX*MAP_REGION_SIZE, mapPosition.y, mapPosition.z + regionY*MAP_REGION_SIZE }, 1.0f, WHITE);
+                            for (int m = 0; m < mapChunks[i].regions[r].meshCount; m++) mapTrianglesDrawn += mapChunks[i].regions[r].meshes[m].triangleCount;
+                        }
+                    }
 
                     // Draw ending cube for reference
                     DrawCube((Vector3){ mapPosition.x + (float)exitCellX, 0.5f, mapPosition.z + (float)exitCellY }, 1.0f, 1.0f, 1.0f, ColorAlpha(GREEN, 0.5f));
@@ -620,13 +820,69 @@ static void UpdateDrawFrame(void)
 
                 if (showMinimapDebug)
                 {
-                    // Draw minimap
-                    DrawTextureEx(texMap, (Vector2){ screenWidth/2 - texMap.width*2, screenHeight/2 - texMap.height*2 }, 0.0f, 4.0f, WHITE);
-                    DrawRectangle(screenWidth/2 - texMap.width*2 + playerCellX*4,screenHeight/2 - texMap.height*2 + playerCellY*4, 4, 4, GB_GREEN04);   // Draw player
-                    DrawRectangle(screenWidth/2 - texMap.width*2 + exitCellX*4,screenHeight/2 - texMap.height*2 + exitCellY*4, 4, 4, LIME);         // Draw exit
+                    // Draw minimap window, texture wraps around it
+                    int minimapWidth = (mapWidth < MINIMAP_SIZE)? mapWidth : MINIMAP_SIZE;
+                    int minimapHeight = (mapHeight < MINIMAP_SIZE)? mapHeight : MINIMAP_SIZE;
+                    Vector2 minimapPosition = { (float)(screenWidth/2 - minimapWidth*2), (float)(screenHeight/2 - minimapHeight*2) };
+
+                    DrawTexturePro(texMinimap, (Rectangle){ (float)minimapX, (float)minimapY, (float)minimapWidth, (float)minimapHeight },
+                        (Rectangle){ minimapPosition.x, minimapPosition.y, minimapWidth*4.0f, minimapHeight*4.0f }, (Vector2){ 0, 0 }, 0.0f, WHITE);
+
+                    if (showHint)
+                    {
+                        // Draw path to exit, following exit distances from player cell, up to minimap border
+                        int pathX = playerCellX;
+                        int pathY = playerCellY;
+
+                        while (GetExitStep(pathX, pathY, &pathX, &pathY) &&
+                               (pathX >= minimapX) && (pathX < (minimapX + minimapWidth)) && (pathY >= minimapY) && (pathY < (minimapY + minimapHeight)))
+                        {
+                            DrawRectangle((int)minimapPosition.x + (pathX - minimapX)*4 + 1, (int)minimapPosition.y + (pathY - minimapY)*4 + 1, 2, 2, GB_GREEN04);
+                        }
+                    }
+
+                    DrawRectangle((int)minimapPosition.x + (playerCellX - minimapX)*4, (int)minimapPosition.y + (playerCellY - minimapY)*4, 4, 4, GB_GREEN04);   // Draw player
+
+                    // Draw exit, once explored
+                    if (IsMinimapCellExplored(exitCellX, exitCellY) &&
+                        (exitCellX >= minimapX) && (exitCellX < (minimapX + minimapWidth)) && (exitCellY >= minimapY) && (exitCellY < (minimapY + minimapHeight)))
+                    {
+                        DrawRectangle((int)minimapPosition.x + (exitCellX - minimapX)*4, (int)minimapPosition.y + (exitCellY - minimapY)*4, 4, 4, LIME);
+                    }
                     //DrawTextEx(font, TextFormat("PLAYER POSITION: [%i, %i]", playerCellX, playerCellY), (Vector2){ 10, screenHeight - 16 }, font.baseSize, 1, GB_GREEN03);
                 }
 
+                if (showHint)
+                {
+                    // Draw hint arrow, pointing to the path to exit a few cells ahead of player
+                    int hintX = playerCellX;
+                    int hintY = playerCellY;
+
+                    for (int i = 0; (i < HINT_CELLS_AHEAD) && GetExitStep(hintX, hintY, &hintX, &hintY); i++) { }
+
+                    if ((hintX != playerCellX) || (hintY != playerCellY))
+                    {
+                        // Arrow angle from camera forward direction (positive to the right)
+                        Vector2 forward = { camera.target.x - camera.position.x, camera.target.z - camera.position.z };
+                        Vector2 toHint = { mapPosition.x + hintX - camera.position.x, mapPosition.z + hintY - camera.position.z };
+                        float angle = atan2f(forward.x*toHint.y - forward.y*toHint.x, forward.x*toHint.x + forward.y*toHint.y);
+
+                        Vector2 center = { screenWidth/2.0f, 24.0f };
+                        Vector2 direction = { sinf(angle), -cosf(angle) };
+                        Vector2 side = { direction.y, -direction.x };
+
+                        DrawTriangle(Vector2Add(center, Vector2Scale(direction, 10.0f)),
+                            Vector2Add(Vector2Subtract(center, Vector2Scale(direction, 6.0f)), Vector2Scale(side, 7.0f)),
+                            Vector2Subtract(Vector2Subtract(center, Vector2Scale(direction, 6.0f)), Vector2Scale(side, 7.0f)), GB_GREEN03);
+                    }
+                }
+
+                if (showDebugInfo)
+                {
+                    DrawTextEx(font, TextFormat("TRIANGLES: %i/%i", mapTrianglesDrawn, mapTrianglesLoaded), (Vector2){ 10, 10 }, font.baseSize, 1, GB_GREEN03);
+                    DrawTextEx(font, TextFormat("FPS: %i (%s)", GetFPS(), (targetFPS > 0)? TextFormat("%i", targetFPS) : "UNCAPPED"), (Vector2){ 10, 22 }, font.baseSize, 1, GB_GREEN03);
+                }
+
                 if (showInGameMenu)
                 {
                     DrawRectangle(0, 80, screenWidth, 84, GB_GREEN01);
@@ -694,10 +950,14 @@ static void UpdateDrawFrame(void)
     //----------------------------------------------------------------------------------
 }
 
-// Update camera custom (first person)
-void UpdateCameraCustom(Camera *camera)
+// Update gameplay tick (fixed rate: GAMEPLAY_TICK_RATE)
+// NOTE: Player movement, stamina and time limit only advance on ticks, so the game
+// plays the same at any render rate
+static void UpdateGameplayTick(void)
 {
-    // Inputs detection
+    previousCameraPosition = camera.position;   // Store previous camera position (to slide from in case of collision, and to interpolate)
+
+    // Player movement, a fixed distance per tick in the directions pressed
     bool direction[4] = { (IsKeyDown(KEY_W) || (GetGamepadAxisMovement(0, 7) < 0)),
                           (IsKeyDown(KEY_S) || (GetGamepadAxisMovement(0, 7) > 0)),
                           (IsKeyDown(KEY_D) || (GetGamepadAxisMovement(0, 6) > 0)),
@@ -706,29 +966,1039 @@ void UpdateCameraCustom(Camera *camera)
     if (direction[0] || direction[1] || direction[2] || direction[3]) playerMoving = true;
     else playerMoving = false;
 
-    Vector3 movement = {0};
+    Vector3 movement = { 0 };
     if (direction[0]) movement.x += 0.05f;
     if (direction[1]) movement.x -= 0.05f;
     if (direction[2]) movement.y += 0.05f;
     if (direction[3]) movement.y -= 0.05f;
 
+    UpdateCameraPro(&camera, movement, (Vector3){ 0.0f, 0.0f, 0.0f }, 0.0f);
+
+    // Check player collision (we simplify to 2D collision detection)
+    // NOTE: Movement is resolved one axis at a time, so the player slides along
+    // walls instead of stopping, only the blocked axis movement is canceled
+    Vector2 playerPos = { previousCameraPosition.x, previousCameraPosition.z };
+
+    playerPos.x = camera.position.x;
+    if (CheckCollisionMapWalls(playerPos, PLAYER_COLLISION_RADIUS)) playerPos.x = previousCameraPosition.x;
+
+    playerPos.y = camera.position.z;
+    if (CheckCollisionMapWalls(playerPos, PLAYER_COLLISION_RADIUS)) playerPos.y = previousCameraPosition.z;
+
+    // Camera target is moved along with position, to keep looking in the same direction
+    camera.target.x += (playerPos.x - camera.position.x);
+    camera.target.z += (playerPos.y - camera.position.z);
+    camera.position.x = playerPos.x;
+    camera.position.z = playerPos.y;
+
+    playerCellX = (int)(playerPos.x - mapPosition.x + 0.5f);
+    playerCellY = (int)(playerPos.y - mapPosition.z + 0.5f);
+
+    // Out-of-limits security check
+    if (playerCellX < 0) playerCellX = 0;
+    else if (playerCellX >= mapWidth) playerCellX = mapWidth - 1;
+
+    if (playerCellY < 0) playerCellY = 0;
+    else if (playerCellY >= mapHeight) playerCellY = mapHeight - 1;
+
+    // Load new map chunks around player (if required)
+    // NOTE: Only one chunk is loaded per tick, player chunk neighbours are loaded
+    // well before they are reached, so chunks loading cost is spread between ticks
+    UpdateMapChunks(playerCellX, playerCellY, 1);
+
+    // Generate loaded map chunks PVS (if required)
+    // NOTE: Only a few cells are generated per tick, cells without PVS draw all loaded regions
+    UpdateMapChunksPVS(playerCellX, playerCellY, MAP_PVS_CELLS_PER_TICK);
+
+    UpdateExitDistances(EXIT_DISTANCES_TIME_BUDGET);    // Keep computing exit distances (if not complete or exit moved)
+
+    UpdateMinimap(playerCellX, playerCellY);    // Reveal minimap cells around player
+
+    // Check ending condition: reach destination
+    if ((playerCellX == exitCellX) && (playerCellY == exitCellY))
+    {
+        currentScreen = ENDING;
+        PlaySound(fxEnding);
+        endingResult = 1;           // Player wins
+
+        StopMusicStream(musicGameplay);
+    }
+
+    // Check ending condition: time limit
+    // NOTE: framesCounter counts gameplay ticks, GAMEPLAY_TICK_RATE per second
+    framesCounter++;
+    if (framesCounter == GAMEPLAY_TICK_RATE)
+    {
+        timeLevelSeconds--;
+        framesCounter = 0;
+        if (timeLevelSeconds == 0)
+        {
+            currentScreen = ENDING;
+            PlaySound(fxEnding);
+
+            StopMusicStream(musicGameplay);
+        }
+    }
+
+    // Check ending condition: stamina level
+    if (staminaLevel < 0.0f)
+    {
+        currentScreen = ENDING;
+        PlaySound(fxEnding);
+        StopMusicStream(musicGameplay);
+    }
+
+    // Steps sounds
+    if (playerMoving)
+    {
+        staminaLevel -= 0.01f;
+        stepFrameCount++;
+
+        if (stepFrameCount%20 == 0)
+        {
+            SetSoundPitch(fxStep, (float)GetRandomValue(80, 120)/100.0f);
+            PlaySound(fxStep);
+        }
+    }
+}
+
+// Update camera custom (first person)
+// NOTE: Only camera rotation (mouse look) is updated every frame, movement is updated on gameplay ticks
+void UpdateCameraCustom(Camera *camera)
+{
     Vector3 rotation = {0};
     rotation.x += GetMouseDelta().x*0.05f;
     rotation.y += GetMouseDelta().y*0.05f;
 
-    UpdateCameraPro(camera, movement, rotation, 0.0f);
+    UpdateCameraPro(camera, (Vector3){ 0.0f, 0.0f, 0.0f }, rotation, 0.0f);
 }
 
-// Check if gamepad axis has been pressed
-static bool IsGamepadAxisAsButtonPressed(int gamepad, int axis, bool positiveAxis)
+// Load walls bitset from map image (white pixels)
+// NOTE: Map size is kept in mapWidth/mapHeight
+static unsigned char *LoadMapWalls(Image map)
 {
-    bool pressed = false;
+    Color *pixels = LoadImageColors(map);
+    unsigned char *walls = (unsigned char *)calloc((map.width*map.height + 7)/8, 1);
 
-    if ((int)roundf(previousGamepadAxisValue[axis]) == 0)
+    mapWidth = map.width;
+    mapHeight = map.height;
+
+    for (int i = 0; i < map.width*map.height; i++)
     {
-        if (positiveAxis && (currentGamepadAxisValue[axis] > 0.2f)) pressed = true; // Positive axis pressed
-        if (!positiveAxis && (currentGamepadAxisValue[axis] < -0.2f)) pressed = true;            // Negative axis pressed
+        if (pixels[i].r == 255) walls[i/8] |= (1 << (i%8));    // Wall: white pixel, only check R channel
     }
 
-    return pressed;
-}
\ No newline at end of file
+    UnloadImageColors(pixels);
+
+    return walls;
+}
+
+// Check if map cell is a wall (cells out of map are)
+static bool IsMapWall(int x, int y)
+{
+    if ((x < 0) || (y < 0) || (x >= mapWidth) || (y >= mapHeight)) return true;
+
+    int i = y*mapWidth + x;
+
+    return (mapWalls[i/8] & (1 << (i%8))) != 0;
+}
+
+// Check collision with walls around position
+// NOTE: Only the 3x3 cells around the position cell are checked, radius must be
+// smaller than half a cell, so collision cost does not depend on map size
+static bool CheckCollisionMapWalls(Vector2 position, float radius)
+{
+    int cellX = (int)floorf(position.x - mapPosition.x + 0.5f);
+    int cellY = (int)floorf(position.y - mapPosition.z + 0.5f);
+
+    for (int y = cellY - 1; y <= cellY + 1; y++)
+    {
+        for (int x = cellX - 1; x <= cellX + 1; x++)
+        {
+            if (IsMapWall(x, y) &&
+                CheckCollisionCircleRec(position, radius,
+                (Rectangle){ mapPosition.x - 0.5f + x*1.0f, mapPosition.z - 0.5f + y*1.0f, 1.0f, 1.0f })) return true;
+        }
+    }
+
+    return false;
+}
+
+// Generate maze walls bitset (recursive backtracker)
+// NOTE: Maze cells are the odd map cells, walls in between are carved while visiting them,
+// map size is (2*width + 1)x(2*height + 1), kept in mapWidth/mapHeight. Backtracking follows
+// the direction every cell was reached from, so no stack is required
+static unsigned char *GenMazeWalls(int width, int height, unsigned int seed)
+{
+    static const int offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+    mapWidth = 2*width + 1;
+    mapHeight = 2*height + 1;
+
+    unsigned char *walls = (unsigned char *)malloc((mapWidth*mapHeight + 7)/8);
+    unsigned char *from = (unsigned char *)calloc(width*height, 1);     // Direction every cell was reached from (1..4), 0 if not visited
+
+    memset(walls, 0xff, (mapWidth*mapHeight + 7)/8);
+
+    SetRandomSeed(seed);
+
+    int x = 0;
+    int y = 0;
+    int i = mapWidth + 1;
+
+    from[0] = 5;        // First cell, no direction to go back
+    walls[i/8] &= ~(1 << (i%8));
+
+    while (true)
+    {
+        // Look for the neighbour cells not visited yet
+        int next[4] = { 0 };
+        int count = 0;
+
+        for (int d = 0; d < 4; d++)
+        {
+            int nx = x + offsets[d][0];
+            int ny = y + offsets[d][1];
+
+            if ((nx >= 0) && (ny >= 0) && (nx < width) && (ny < height) && (from[ny*width + nx] == 0)) next[count++] = d;
+        }
+
+        if (count > 0)
+        {
+            // Carve the wall to a random neighbour and move to it
+            int d = next[GetRandomValue(0, count - 1)];
+
+            i = (2*y + 1 + offsets[d][1])*mapWidth + 2*x + 1 + offsets[d][0];
+            walls[i/8] &= ~(1 << (i%8));
+
+            x += offsets[d][0];
+            y += offsets[d][1];
+            from[y*width + x] = d + 1;
+
+            i = (2*y + 1)*mapWidth + 2*x + 1;
+            walls[i/8] &= ~(1 << (i%8));
+        }
+        else if (from[y*width + x] <= 4)
+        {
+            // Dead end, go back to the cell we came from
+            int d = from[y*width + x] - 1;
+
+            x -= offsets[d][0];
+            y -= offsets[d][1];
+        }
+        else break;     // Back to first cell, all cells visited
+    }
+
+    free(from);
+
+    return walls;
+}
+
+// Load map region model, walls faces merged into bigger quads
+// NOTE: Faces between walls, facing out of the map or on top/bottom of walls are never visible,
+// so they are not generated. Coplanar adjacent faces with the same texture tile are merged into
+// one quad, with texture coordinates in map cells, repeating the tile texture along the quad.
+// Region must be up to 8192 cells, so vertex indices fit in 16 bit
+static Model LoadMapRegionModel(int x, int y, int width, int height)
+{
+    if ((x + width) > mapWidth) width = mapWidth - x;
+    if ((y + height) > mapHeight) height = mapHeight - y;
+
+    Mesh meshes[MAP_TILES] = { 0 };
+
+    // NOTE: Every map cell adds at most 2 quads per tile (i.e. front and right walls faces)
+    for (int t = 0; t < MAP_TILES; t++)
+    {
+        meshes[t].vertices = (float *)MemAlloc(width*height*2*4*3*sizeof(float));
+        meshes[t].texcoords = (float *)MemAlloc(width*height*2*4*2*sizeof(float));
+        meshes[t].normals = (float *)MemAlloc(width*height*2*4*3*sizeof(float));
+        meshes[t].indices = (unsigned short *)MemAlloc(width*height*2*6*sizeof(unsigned short));
+    }
+
+    // Walls front and back faces, merging runs of walls along each row
+    for (int j = 0; j < height; j++)
+    {
+        int frontStart = -1;
+        int backStart = -1;
+
+        for (int i = 0; i <= width; i++)
+        {
+            bool wall = (i < width) && IsMapWall(x + i, y + j);
+            bool front = wall && !IsMapWall(x + i, y + j + 1);
+            bool back = wall && !IsMapWall(x + i, y + j - 1);
+
+            if (front && (frontStart < 0)) frontStart = i;
+            else if (!front && (frontStart >= 0))
+            {
+                AddMapQuad(&meshes[MAP_TILE_WALL_A], (Vector3){ frontStart - 0.5f, 1.0f, j + 0.5f }, (Vector3){ (float)(i - frontStart), 0.0f, 0.0f }, (Vector3){ 0.0f, -1.0f, 0.0f });
+                frontStart = -1;
+            }
+
+            if (back && (backStart < 0)) backStart = i;
+            else if (!back && (backStart >= 0))
+            {
+                AddMapQuad(&meshes[MAP_TILE_WALL_B], (Vector3){ i - 0.5f, 1.0f, j - 0.5f }, (Vector3){ (float)(backStart - i), 0.0f, 0.0f }, (Vector3){ 0.0f, -1.0f, 0.0f });
+                backStart = -1;
+            }
+        }
+    }
+
+    // Walls right and left faces, merging runs of walls along each column
+    for (int i = 0; i < width; i++)
+    {
+        int rightStart = -1;
+        int leftStart = -1;
+
+        for (int j = 0; j <= height; j++)
+        {
+            bool wall = (j < height) && IsMapWall(x + i, y + j);
+            bool right = wall && !IsMapWall(x + i + 1, y + j);
+            bool left = wall && !IsMapWall(x + i - 1, y + j);
+
+            if (right && (rightStart < 0)) rightStart = j;
+            else if (!right && (rightStart >= 0))
+            {
+                AddMapQuad(&meshes[MAP_TILE_WALL_A], (Vector3){ i + 0.5f, 1.0f, j - 0.5f }, (Vector3){ 0.0f, 0.0f, (float)(rightStart - j) }, (Vector3){ 0.0f, -1.0f, 0.0f });
+                rightStart = -1;
+            }
+
+            if (left && (leftStart < 0)) leftStart = j;
+            else if (!left && (leftStart >= 0))
+            {
+                AddMapQuad(&meshes[MAP_TILE_WALL_B], (Vector3){ i - 0.5f, 1.0f, leftStart - 0.5f }, (Vector3){ 0.0f, 0.0f, (float)(j - leftStart) }, (Vector3){ 0.0f, -1.0f, 0.0f });
+                leftStart = -1;
+            }
+        }
+    }
+
+    // Floor and ceiling, merging floor cells into rectangles: grown along the row first and
+    // then down, while the whole row of cells below is floor not merged yet
+    bool *merged = (bool *)calloc(width*height, sizeof(bool));
+
+    for (int j = 0; j < height; j++)
+    {
+        for (int i = 0; i < width; i++)
+        {
+            if (merged[j*width + i] || IsMapWall(x + i, y + j)) continue;
+
+            int w = 1;
+            int h = 1;
+
+            while (((i + w) < width) && !merged[j*width + i + w] && !IsMapWall(x + i + w, y + j)) w++;
+
+            for (bool grow = true; grow && ((j + h) < height); )
+            {
+                for (int k = 0; k < w; k++)
+                {
+                    if (merged[(j + h)*width + i + k] || IsMapWall(x + i + k, y + j + h)) grow = false;
+                }
+
+                if (grow) h++;
+            }
+
+            for (int l = 0; l < h; l++)
+            {
+                for (int k = 0; k < w; k++) merged[(j + l)*width + i + k] = true;
+            }
+
+            AddMapQuad(&meshes[MAP_TILE_FLOOR], (Vector3){ i - 0.5f, 0.0f, j - 0.5f }, (Vector3){ (float)w, 0.0f, 0.0f }, (Vector3){ 0.0f, 0.0f, (float)h });
+            AddMapQuad(&meshes[MAP_TILE_CEILING], (Vector3){ i + w - 0.5f, 1.0f, j - 0.5f }, (Vector3){ (float)-w, 0.0f, 0.0f }, (Vector3){ 0.0f, 0.0f, (float)h });
+        }
+    }
+
+    free(merged);
+
+    // Load model, one mesh/material per tile (empty tiles skipped)
+    Model model = { 0 };
+    int vertexCount = 0;
+    int triangleCount = 0;
+
+    model.transform = MatrixIdentity();
+    model.meshes = (Mesh *)MemAlloc(MAP_TILES*sizeof(Mesh));
+    model.materials = (Material *)MemAlloc(MAP_TILES*sizeof(Material));
+    model.meshMaterial = (int *)MemAlloc(MAP_TILES*sizeof(int));
+
+    for (int t = 0; t < MAP_TILES; t++)
+    {
+        Mesh mesh = meshes[t];
+
+        if (mesh.vertexCount == 0)
+        {
+            MemFree(mesh.vertices);
+            MemFree(mesh.texcoords);
+            MemFree(mesh.normals);
+            MemFree(mesh.indices);
+            continue;
+        }
+
+        // Shrink mesh data to the quads generated
+        mesh.vertices = (float *)MemRealloc(mesh.vertices, mesh.vertexCount*3*sizeof(float));
+        mesh.texcoords = (float *)MemRealloc(mesh.texcoords, mesh.vertexCount*2*sizeof(float));
+        mesh.normals = (float *)MemRealloc(mesh.normals, mesh.vertexCount*3*sizeof(float));
+        mesh.indices = (unsigned short *)MemRealloc(mesh.indices, mesh.triangleCount*3*sizeof(unsigned short));
+
+        UploadMesh(&mesh, false);
+
+        vertexCount += mesh.vertexCount;
+        triangleCount += mesh.triangleCount;
+
+        model.meshes[model.meshCount] = mesh;
+        model.materials[model.meshCount] = LoadMaterialDefault();
+        model.materials[model.meshCount].maps[MATERIAL_MAP_DIFFUSE].texture = texMapTiles[t];
+        model.meshMaterial[model.meshCount] = model.meshCount;
+        model.meshCount++;
+    }
+
+    model.materialCount = model.meshCount;
+
+    TraceLog(LOG_DEBUG, "MAP: [%i, %i | %ix%i] Region model loaded: %i vertices, %i triangles", x, y, width, height, vertexCount, triangleCount);
+
+    return model;
+}
+
+// Add quad to map mesh, from its top-left corner and right/down edges (as seen from the front)
+// NOTE: Texture coordinates are the edges lengths, so the tile texture repeats on every map cell
+static void AddMapQuad(Mesh *mesh, Vector3 corner, Vector3 right, Vector3 down)
+{
+    Vector3 normal = Vector3Normalize(Vector3CrossProduct(down, right));
+    Vector3 positions[4] = { corner, Vector3Add(corner, down), Vector3Add(Vector3Add(corner, down), right), Vector3Add(corner, right) };
+    float u = Vector3Length(right);
+    float v = Vector3Length(down);
+    Vector2 texcoords[4] = { { 0.0f, 0.0f }, { 0.0f, v }, { u, v }, { u, 0.0f } };
+    static const unsigned short quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    for (int i = 0; i < 4; i++)
+    {
+        int k = mesh->vertexCount + i;
+
+        mesh->vertices[k*3] = positions[i].x;
+        mesh->vertices[k*3 + 1] = positions[i].y;
+        mesh->vertices[k*3 + 2] = positions[i].z;
+        mesh->texcoords[k*2] = texcoords[i].x;
+        mesh->texcoords[k*2 + 1] = texcoords[i].y;
+        mesh->normals[k*3] = normal.x;
+        mesh->normals[k*3 + 1] = normal.y;
+        mesh->normals[k*3 + 2] = normal.z;
+    }
+
+    for (int i = 0; i < 6; i++) mesh->indices[mesh->triangleCount*3 + i] = (unsigned short)(mesh->vertexCount + quadIndices[i]);
+
+    mesh->vertexCount += 4;
+    mesh->triangleCount += 2;
+}
+
+// Get quads GenMeshCubicmap() would generate for a map region, for reference
+// NOTE: Floor and ceiling for floor cells, top and bottom for walls plus the sides towards floor cells or region borders
+static int GetMapRegionCubicmapQuads(int x, int y, int width, int height)
+{
+    if ((x + width) > mapWidth) width = mapWidth - x;
+    if ((y + height) > mapHeight) height = mapHeight - y;
+
+    int quads = 0;
+
+    for (int j = 0; j < height; j++)
+    {
+        for (int i = 0; i < width; i++)
+        {
+            quads += 2;
+
+            if (IsMapWall(x + i, y + j))
+            {
+                if ((i == width - 1) || !IsMapWall(x + i + 1, y + j)) quads++;
+                if ((i == 0) || !IsMapWall(x + i - 1, y + j)) quads++;
+                if ((j == height - 1) || !IsMapWall(x + i, y + j + 1)) quads++;
+                if ((j == 0) || !IsMapWall(x + i, y + j - 1)) quads++;
+            }
+        }
+    }
+
+    return quads;
+}
+
+// Generate potentially visible regions of next chunk cells, up to maxCells, MAP_PVS_BYTES per cell
+// NOTE: Rays are cast over the map walls from the center and corners of every floor cell, in
+// MAP_PVS_RAYS directions, marking the regions of the cells they go through, up to the wall they
+// hit. Regions are stored relative to the cell region, only the ones in MAP_PVS_RANGE are kept.
+// Returns the number of cells generated
+static int GenMapChunkPVS(MapChunk *chunk, int maxCells)
+{
+    static const Vector2 samples[5] = { { 0.0f, 0.0f }, { -0.4f, -0.4f }, { 0.4f, -0.4f }, { -0.4f, 0.4f }, { 0.4f, 0.4f } };
+
+    int cells = 0;
+
+    for (; (chunk->pvsCells < MAP_CHUNK_SIZE*MAP_CHUNK_SIZE) && (cells < maxCells); chunk->pvsCells++, cells++)
+    {
+        int i = chunk->pvsCells%MAP_CHUNK_SIZE;
+        int j = chunk->pvsCells/MAP_CHUNK_SIZE;
+        int cellX = chunk->x*MAP_CHUNK_SIZE + i;
+        int cellY = chunk->y*MAP_CHUNK_SIZE + j;
+
+        if (IsMapWall(cellX, cellY)) continue;
+
+        for (int s = 0; s < 5; s++)
+        {
+            for (int r = 0; r < MAP_PVS_RAYS; r++)
+            {
+                CastMapPVSRay(chunk->pvs + (j*MAP_CHUNK_SIZE + i)*MAP_PVS_BYTES, cellX, cellY, samples[s], 2.0f*PI*r/MAP_PVS_RAYS);
+            }
+        }
+    }
+
+    return cells;
+}
+
+// Update loaded map chunks PVS generation, up to maxCells cells
+// NOTE: Chunk containing map cell is generated first, so the player gets culling as soon as possible
+static void UpdateMapChunksPVS(int cellX, int cellY, int maxCells)
+{
+    while (maxCells > 0)
+    {
+        // Look for a chunk with PVS not generated yet, map cell chunk first
+        MapChunk *chunk = NULL;
+
+        for (int i = 0; i < MAX_MAP_CHUNKS; i++)
+        {
+            if (!mapChunks[i].loaded || (mapChunks[i].pvsCells == MAP_CHUNK_SIZE*MAP_CHUNK_SIZE)) continue;
+
+            if ((chunk == NULL) || ((mapChunks[i].x == cellX/MAP_CHUNK_SIZE) && (mapChunks[i].y == cellY/MAP_CHUNK_SIZE))) chunk = &mapChunks[i];
+        }
+
+        if (chunk == NULL) break;
+
+        maxCells -= GenMapChunkPVS(chunk, maxCells);
+    }
+}
+
+// Cast ray from cell over map walls, marking the regions it goes through in cell PVS
+// NOTE: Ray is traversed cell by cell (grid DDA), from origin (relative to cell center)
+// until it hits a wall or goes further than MAP_PVS_RANGE regions
+static void CastMapPVSRay(unsigned char *pvs, int cellX, int cellY, Vector2 origin, float angle)
+{
+    const float maxDistance = (float)(MAP_PVS_RANGE*MAP_REGION_SIZE);
+
+    Vector2 direction = { cosf(angle), sinf(angle) };
+    int stepX = (direction.x < 0.0f)? -1 : 1;
+    int stepY = (direction.y < 0.0f)? -1 : 1;
+
+    // Distance along the ray to cross one cell, and to the first cells borders
+    float deltaX = (direction.x != 0.0f)? fabsf(1.0f/direction.x) : 1e30f;
+    float deltaY = (direction.y != 0.0f)? fabsf(1.0f/direction.y) : 1e30f;
+    float sideX = ((stepX > 0)? (0.5f - origin.x) : (0.5f + origin.x))*deltaX;
+    float sideY = ((stepY > 0)? (0.5f - origin.y) : (0.5f + origin.y))*deltaY;
+
+    int regionX = cellX/MAP_REGION_SIZE;
+    int regionY = cellY/MAP_REGION_SIZE;
+    int x = cellX;
+    int y = cellY;
+
+    while (true)
+    {
+        int dx = x/MAP_REGION_SIZE - regionX;
+        int dy = y/MAP_REGION_SIZE - regionY;
+
+        if ((dx < -MAP_PVS_RANGE) || (dx > MAP_PVS_RANGE) || (dy < -MAP_PVS_RANGE) || (dy > MAP_PVS_RANGE)) break;
+
+        int bit = (dy + MAP_PVS_RANGE)*(2*MAP_PVS_RANGE + 1) + dx + MAP_PVS_RANGE;
+        pvs[bit/8] |= (1 << (bit%8));
+
+        if (IsMapWall(x, y)) break;
+
+        // Move to next cell, the one whose border is nearest along the ray
+        if (sideX < sideY)
+        {
+            if (sideX > maxDistance) break;
+            sideX += deltaX;
+            x += stepX;
+        }
+        else
+        {
+            if (sideY > maxDistance) break;
+            sideY += deltaY;
+            y += stepY;
+        }
+    }
+}
+
+// Check if region is in cell PVS, region relative to cell region
+static bool IsMapRegionVisible(const unsigned char *pvs, int dx, int dy)
+{
+    if ((dx < -MAP_PVS_RANGE) || (dx > MAP_PVS_RANGE) || (dy < -MAP_PVS_RANGE) || (dy > MAP_PVS_RANGE)) return false;
+
+    int bit = (dy + MAP_PVS_RANGE)*(2*MAP_PVS_RANGE + 1) + dx + MAP_PVS_RANGE;
+
+    return (pvs[bit/8] & (1 << (bit%8))) != 0;
+}
+
+// Get map cell PVS, from the loaded chunk containing it
+// NOTE: Returns NULL if cell is a wall, its chunk is not loaded or its PVS is not generated yet
+static const unsigned char *GetMapCellPVS(int cellX, int cellY)
+{
+    if (IsMapWall(cellX, cellY)) return NULL;
+
+    for (int i = 0; i < MAX_MAP_CHUNKS; i++)
+    {
+        if (mapChunks[i].loaded && (mapChunks[i].x == cellX/MAP_CHUNK_SIZE) && (mapChunks[i].y == cellY/MAP_CHUNK_SIZE))
+        {
+            int cell = (cellY%MAP_CHUNK_SIZE)*MAP_CHUNK_SIZE + cellX%MAP_CHUNK_SIZE;
+
+            if (cell >= mapChunks[i].pvsCells) return NULL;
+
+            return mapChunks[i].pvs + cell*MAP_PVS_BYTES;
+        }
+    }
+
+    return NULL;
+}
+
+// Set map exit cell, restarting exit distances field computation
+// NOTE: Field is computed by UpdateExitDistances() over several frames, so the exit can be
+// moved while playing without stalls. Moving the exit clears the whole field and restarts
+// the search, cells reached since then have their final distance
+static void SetMapExit(int x, int y)
+{
+    int cellCount = mapWidth*mapHeight;
+
+    exitCellX = x;
+    exitCellY = y;
+
+    if (exitDistances == NULL) exitDistances = (unsigned char *)malloc((cellCount + 3)/4);
+    memset(exitDistances, 0xff, (cellCount + 3)/4);     // All cells not reached yet
+
+    int i = y*mapWidth + x;
+    exitDistances[i/4] &= ~(3 << ((i%4)*2));    // Exit cell at distance 0
+
+    exitQueueStart = 0;
+    exitQueueEnd = 0;
+    if (exitQueue == NULL)
+    {
+        exitQueueCapacity = 1024;
+        exitQueue = (int *)malloc(exitQueueCapacity*sizeof(int));
+    }
+
+    exitQueue[exitQueueEnd++] = i;
+}
+
+// Update exit distances field (BFS from exit), for up to maxTime seconds
+// NOTE: Cells are computed in batches between time checks, so the field of any map size
+// is complete in a few frames. Walls and distances bits are tested inline, neighbours out
+// of map are skipped by cell index. Returns true if field is complete
+static bool UpdateExitDistances(double maxTime)
+{
+    if (exitQueueStart == exitQueueEnd) return true;
+
+    double endTime = GetTime() + maxTime;
+
+    for (int n = 0; exitQueueStart < exitQueueEnd; n++)
+    {
+        if ((n%EXIT_DISTANCES_BATCH_CELLS == 0) && (n > 0) && (GetTime() >= endTime)) break;
+
+        int i = exitQueue[exitQueueStart++];
+        int x = i%mapWidth;
+        int next = (((exitDistances[i/4] >> ((i%4)*2)) & 3) + 1)%3;
+
+        int neighbours[4] = { (x < (mapWidth - 1))? i + 1 : -1, (x > 0)? i - 1 : -1, i + mapWidth, i - mapWidth };
+
+        for (int d = 0; d < 4; d++)
+        {
+            int k = neighbours[d];
+
+            if ((k < 0) || (k >= mapWidth*mapHeight)) continue;                 // Out of map
+            if (mapWalls[k/8] & (1 << (k%8))) continue;                         // Wall
+            if (((exitDistances[k/4] >> ((k%4)*2)) & 3) != 3) continue;         // Already reached
+
+            exitDistances[k/4] &= ~((3 - next) << ((k%4)*2));
+
+            // Make room in queue, moving pending cells to the start or growing it
+            if (exitQueueEnd == exitQueueCapacity)
+            {
+                if (exitQueueStart > 0)
+                {
+                    memmove(exitQueue, exitQueue + exitQueueStart, (exitQueueEnd - exitQueueStart)*sizeof(int));
+                    exitQueueEnd -= exitQueueStart;
+                    exitQueueStart = 0;
+                }
+                else
+                {
+                    exitQueueCapacity *= 2;
+                    exitQueue = (int *)realloc(exitQueue, exitQueueCapacity*sizeof(int));
+                }
+            }
+
+            exitQueue[exitQueueEnd++] = k;
+        }
+    }
+
+    return (exitQueueStart == exitQueueEnd);
+}
+
+// Get cell distance to exit modulo 3 (3: wall or not reached yet)
+static int GetExitDistanceCode(int x, int y)
+{
+    if ((x < 0) || (y < 0) || (x >= mapWidth) || (y >= mapHeight)) return 3;
+
+    int i = y*mapWidth + x;
+
+    return (exitDistances[i/4] >> ((i%4)*2)) & 3;
+}
+
+// Get next cell towards exit from cell (one step closer)
+// NOTE: Neighbour cells distances differ at most by one, so the one closer to the exit
+// is the one with distance code one less (modulo 3). Returns false if there is no next
+// cell: cell is the exit, a wall or not reached yet
+static bool GetExitStep(int x, int y, int *nextX, int *nextY)
+{
+    static const int offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+    int code = GetExitDistanceCode(x, y);
+
+    if ((code == 3) || ((x == exitCellX) && (y == exitCellY))) return false;
+
+    for (int d = 0; d < 4; d++)
+    {
+        if (GetExitDistanceCode(x + offsets[d][0], y + offsets[d][1]) == (code + 2)%3)
+        {
+            *nextX = x + offsets[d][0];
+            *nextY = y + offsets[d][1];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Reset minimap fog of war, with window around map cell
+// NOTE: Full minimap texture is only updated here, on game start
+static void ResetMinimap(int cellX, int cellY)
+{
+    memset(minimapExplored, 0, (mapWidth*mapHeight + 7)/8);
+
+    ImageClearBackground(&imMinimap, GB_GREEN01);
+    UpdateTexture(texMinimap, imMinimap.data);
+
+    minimapX = ClampMinimapOrigin(cellX - MINIMAP_SIZE/2, mapWidth);
+    minimapY = ClampMinimapOrigin(cellY - MINIMAP_SIZE/2, mapHeight);
+}
+
+// Update minimap, scrolling window to map cell and revealing cells around it
+// NOTE: Only texels of cells entering the window or newly revealed are patched, minimap texture
+// wraps around the window, so cost does not depend on map size
+static void UpdateMinimap(int cellX, int cellY)
+{
+    int originX = ClampMinimapOrigin(cellX - MINIMAP_SIZE/2, mapWidth);
+    int originY = ClampMinimapOrigin(cellY - MINIMAP_SIZE/2, mapHeight);
+    int width = (mapWidth < MINIMAP_SIZE)? mapWidth : MINIMAP_SIZE;
+    int height = (mapHeight < MINIMAP_SIZE)? mapHeight : MINIMAP_SIZE;
+
+    // Scroll window, patching columns and rows entering it
+    if ((abs(originX - minimapX) >= width) || (abs(originY - minimapY) >= height))
+    {
+        minimapX = originX;
+        minimapY = originY;
+        for (int i = 0; i < width; i++) PatchMinimapColumn(minimapX + i);
+    }
+    else
+    {
+        int prevX = minimapX;
+        int prevY = minimapY;
+
+        minimapX = originX;
+        minimapY = originY;
+
+        for (int x = prevX + width; x < originX + width; x++) PatchMinimapColumn(x);    // Scrolled right
+        for (int x = originX; x < prevX; x++) PatchMinimapColumn(x);                    // Scrolled left
+        for (int y = prevY + height; y < originY + height; y++) PatchMinimapRow(y);     // Scrolled down
+        for (int y = originY; y < prevY; y++) PatchMinimapRow(y);                       // Scrolled up
+    }
+
+    // Reveal cells around map cell
+    for (int y = cellY - 1; y <= cellY + 1; y++)
+    {
+        for (int x = cellX - 1; x <= cellX + 1; x++) RevealMinimapCell(x, y);
+    }
+
+    // Reveal straight corridors from map cell, with their side walls
+    const int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+    for (int d = 0; d < 4; d++)
+    {
+        int dx = directions[d][0];
+        int dy = directions[d][1];
+
+        for (int i = 1; i <= MINIMAP_REVEAL_RANGE; i++)
+        {
+            int x = cellX + dx*i;
+            int y = cellY + dy*i;
+
+            RevealMinimapCell(x, y);
+            RevealMinimapCell(x + dy, y + dx);
+            RevealMinimapCell(x - dy, y - dx);
+
+            if (IsMapWall(x, y)) break;
+        }
+    }
+}
+
+// Reveal map cell on minimap, patching its texel (if inside window)
+static void RevealMinimapCell(int x, int y)
+{
+    if ((x < 0) || (y < 0) || (x >= mapWidth) || (y >= mapHeight)) return;
+
+    if (IsMinimapCellExplored(x, y)) return;
+
+    int index = y*mapWidth + x;
+    minimapExplored[index/8] |= (1 << (index%8));
+
+    if ((x >= minimapX) && (x < (minimapX + MINIMAP_SIZE)) && (y >= minimapY) && (y < (minimapY + MINIMAP_SIZE)))
+    {
+        Color *pixels = (Color *)imMinimap.data;
+        int texel = (y%MINIMAP_SIZE)*MINIMAP_SIZE + x%MINIMAP_SIZE;
+
+        pixels[texel] = GetMinimapCellColor(x, y);
+        UpdateTextureRec(texMinimap, (Rectangle){ (float)(x%MINIMAP_SIZE), (float)(y%MINIMAP_SIZE), 1, 1 }, &pixels[texel]);
+    }
+}
+
+// Patch minimap texture column of map cells column (window rows)
+static void PatchMinimapColumn(int x)
+{
+    Color *pixels = (Color *)imMinimap.data;
+    Color column[MINIMAP_SIZE] = { 0 };
+    int height = (mapHeight < MINIMAP_SIZE)? mapHeight : MINIMAP_SIZE;
+
+    // NOTE: Window rows wrap around texture, but they cover all texture rows
+    // (or the first mapHeight ones, for small maps)
+    for (int y = minimapY; y < (minimapY + height); y++)
+    {
+        int texel = (y%MINIMAP_SIZE)*MINIMAP_SIZE + x%MINIMAP_SIZE;
+
+        pixels[texel] = GetMinimapCellColor(x, y);
+        column[y%MINIMAP_SIZE] = pixels[texel];
+    }
+
+    UpdateTextureRec(texMinimap, (Rectangle){ (float)(x%MINIMAP_SIZE), 0, 1, (float)height }, column);
+}
+
+// Patch minimap texture row of map cells row (window columns)
+static void PatchMinimapRow(int y)
+{
+    Color *pixels = (Color *)imMinimap.data;
+    int width = (mapWidth < MINIMAP_SIZE)? mapWidth : MINIMAP_SIZE;
+
+    for (int x = minimapX; x < (minimapX + width); x++) pixels[(y%MINIMAP_SIZE)*MINIMAP_SIZE + x%MINIMAP_SIZE] = GetMinimapCellColor(x, y);
+
+    UpdateTextureRec(texMinimap, (Rectangle){ 0, (float)(y%MINIMAP_SIZE), (float)width, 1 }, &pixels[(y%MINIMAP_SIZE)*MINIMAP_SIZE]);
+}
+
+// Get minimap color of map cell (fog for cells not explored)
+static Color GetMinimapCellColor(int x, int y)
+{
+    if (!IsMinimapCellExplored(x, y)) return GB_GREEN01;
+    else if (IsMapWall(x, y)) return GB_GREEN03;
+    else return GB_GREEN02;
+}
+
+// Check if map cell is explored (revealed on minimap)
+// NOTE: Cells out of map are never explored
+static bool IsMinimapCellExplored(int x, int y)
+{
+    if ((x < 0) || (y < 0) || (x >= mapWidth) || (y >= mapHeight)) return false;
+
+    int index = y*mapWidth + x;
+
+    return (minimapExplored[index/8] & (1 << (index%8)));
+}
+
+// Clamp minimap window origin to map (in map cells)
+static int ClampMinimapOrigin(int origin, int mapSize)
+{
+    if (origin > (mapSize - MINIMAP_SIZE)) origin = mapSize - MINIMAP_SIZE;
+    if (origin < 0) origin = 0;
+
+    return origin;
+}
+
+// Update map chunks loaded around map cell
+// NOTE: Missing chunks in load radius are generated and uploaded, taking a free slot or
+// the one of the farthest chunk, so chunks left behind are unloaded as player moves and
+// the chunks in memory are bounded, no matter the map size. Up to maxLoads chunks are loaded
+static void UpdateMapChunks(int cellX, int cellY, int maxLoads)
+{
+    int loads = 0;
+
+    int chunkX = cellX/MAP_CHUNK_SIZE;
+    int chunkY = cellY/MAP_CHUNK_SIZE;
+    int chunksX = (mapWidth + MAP_CHUNK_SIZE - 1)/MAP_CHUNK_SIZE;
+    int chunksY = (mapHeight + MAP_CHUNK_SIZE - 1)/MAP_CHUNK_SIZE;
+
+    for (int y = chunkY - MAP_CHUNK_LOAD_RADIUS; y <= chunkY + MAP_CHUNK_LOAD_RADIUS; y++)
+    {
+        for (int x = chunkX - MAP_CHUNK_LOAD_RADIUS; x <= chunkX + MAP_CHUNK_LOAD_RADIUS; x++)
+        {
+            if ((x < 0) || (y < 0) || (x >= chunksX) || (y >= chunksY)) continue;
+
+            bool found = false;
+            for (int i = 0; i < MAX_MAP_CHUNKS; i++)
+            {
+                if (mapChunks[i].loaded && (mapChunks[i].x == x) && (mapChunks[i].y == y)) found = true;
+            }
+
+            if (found) continue;
+            if (loads == maxLoads) return;
+
+            // Look for a free slot, the farthest chunk one otherwise
+            int slot = 0;
+            int slotDistance = -1;
+
+            for (int i = 0; i < MAX_MAP_CHUNKS; i++)
+            {
+                if (!mapChunks[i].loaded)
+                {
+                    slot = i;
+                    break;
+                }
+
+                int distance = abs(mapChunks[i].x - chunkX);
+                if (abs(mapChunks[i].y - chunkY) > distance) distance = abs(mapChunks[i].y - chunkY);
+
+                if (distance > slotDistance)
+                {
+                    slot = i;
+                    slotDistance = distance;
+                }
+            }
+
+            if (mapChunks[slot].loaded) UnloadMapChunk(&mapChunks[slot]);
+
+            // Generate chunk regions models
+            // NOTE: Regions out of the map (last chunks) are left empty
+            int vertexCount = 0;
+            int triangleCount = 0;
+            int cubicmapQuads = GetMapRegionCubicmapQuads(x*MAP_CHUNK_SIZE, y*MAP_CHUNK_SIZE, MAP_CHUNK_SIZE, MAP_CHUNK_SIZE);
+
+            for (int r = 0; r < MAP_CHUNK_REGIONS*MAP_CHUNK_REGIONS; r++)
+            {
+                int regionX = x*MAP_CHUNK_SIZE + (r%MAP_CHUNK_REGIONS)*MAP_REGION_SIZE;
+                int regionY = y*MAP_CHUNK_SIZE + (r/MAP_CHUNK_REGIONS)*MAP_REGION_SIZE;
+
+                if ((regionX >= mapWidth) || (regionY >= mapHeight)) mapChunks[slot].regions[r] = (Model){ 0 };
+                else mapChunks[slot].regions[r] = LoadMapRegionModel(regionX, regionY, MAP_REGION_SIZE, MAP_REGION_SIZE);
+
+                for (int m = 0; m < mapChunks[slot].regions[r].meshCount; m++)
+                {
+                    vertexCount += mapChunks[slot].regions[r].meshes[m].vertexCount;
+                    triangleCount += mapChunks[slot].regions[r].meshes[m].triangleCount;
+                }
+            }
+
+            // NOTE: PVS is generated later, a few cells per tick (see UpdateMapChunksPVS())
+            mapChunks[slot].pvs = (unsigned char *)calloc(MAP_CHUNK_SIZE*MAP_CHUNK_SIZE*MAP_PVS_BYTES, 1);
+            mapChunks[slot].pvsCells = 0;
+            mapChunks[slot].x = x;
+            mapChunks[slot].y = y;
+            mapChunks[slot].loaded = true;
+            mapTrianglesLoaded += triangleCount;
+            loads++;
+
+            TraceLog(LOG_INFO, "MAP: [%i, %i] Chunk loaded: %i vertices, %i triangles (cubicmap: %i vertices, %i triangles)",
+                x, y, vertexCount, triangleCount, cubicmapQuads*6, cubicmapQuads*2);
+        }
+    }
+}
+
+// Unload map chunk regions models and PVS
+static void UnloadMapChunk(MapChunk *chunk)
+{
+    for (int r = 0; r < MAP_CHUNK_REGIONS*MAP_CHUNK_REGIONS; r++)
+    {
+        for (int m = 0; m < chunk->regions[r].meshCount; m++) mapTrianglesLoaded -= chunk->regions[r].meshes[m].triangleCount;
+
+        if (chunk->regions[r].meshes != NULL) UnloadModel(chunk->regions[r]);
+    }
+
+    free(chunk->pvs);
+    chunk->pvs = NULL;
+    chunk->pvsCells = 0;
+    chunk->loaded = false;
+}
+
+// Unload all map chunks
+static void UnloadMapChunks(void)
+{
+    for (int i = 0; i < MAX_MAP_CHUNKS; i++)
+    {
+        if (mapChunks[i].loaded) UnloadMapChunk(&mapChunks[i]);
+    }
+}
+
+// Check if gamepad axis has been pressed
+static bool IsGamepadAxisAsButtonPressed(int gamepad, int axis, bool positiveAxis)
+{
+    bool pressed = false;
+
+    if ((int)roundf(previousGamepadAxisValue[axis]) == 0)
+    {
+        if (positiveAxis && (currentGamepadAxisValue[axis] > 0.2f)) pressed = true; // Positive axis pressed
+        if (!positiveAxis && (currentGamepadAxisValue[axis] < -0.2f)) pressed = true;            // Negative axis pressed
+    }
+
+    return pressed;
+}
+
+// Load assets data, reading and decoding files (run by assets loader thread)
+// NOTE: Only CPU work is done here, GPU textures and audio sounds are created on main thread
+// by UploadAssets(), music streams are created here, decoding from file data kept in memory
+static void *LoadAssetsData(void *arg)
+{
+    (void)arg;
+
+    for (int i = 0; i < ASSETS_COUNT; i++)
+    {
+        Asset *asset = &assets[i];
+        const char *fileType = GetFileExtension(asset->fileName);
+
+        asset->fileData = LoadFileData(asset->fileName, &asset->fileSize);
+
+        switch (asset->type)
+        {
+            case ASSET_TEXTURE:
+            case ASSET_FONT: asset->image = LoadImageFromMemory(fileType, asset->fileData, asset->fileSize); break;
+            case ASSET_SOUND: asset->wave = LoadWaveFromMemory(fileType, asset->fileData, asset->fileSize); break;
+            case ASSET_MUSIC: asset->music = LoadMusicStreamFromMemory(fileType, asset->fileData, asset->fileSize); break;
+            default: break;
+        }
+
+        // File data is only required by music, streamed from memory
+        if (asset->type != ASSET_MUSIC)
+        {
+            UnloadFileData(asset->fileData);
+            asset->fileData = NULL;
+        }
+
+        assetsDecoded = i + 1;      // Asset ready to be uploaded by main thread
+    }
+
+    return NULL;
+}
+
+// Upload assets decoded by loader thread (GPU textures, audio sounds)
+static void UploadAssets(void)
+{
+    int decoded = assetsDecoded;
+
+    for (; assetsUploaded < decoded; assetsUploaded++)
+    {
+        Asset *asset = &assets[assetsUploaded];
+
+        switch (asset->type)
+        {
+            case ASSET_TEXTURE: *(Texture2D *)asset->target = LoadTextureFromImage(asset->image); break;
+            case ASSET_FONT: *(Font *)asset->target = LoadFontFromImage(asset->image, MAGENTA, 32); break;  // Same as LoadFont() for image fonts
+            case ASSET_SOUND: *(Sound *)asset->target = LoadSoundFromWave(asset->wave); break;
+            case ASSET_MUSIC: *(Music *)asset->target = asset->music; break;
+            default: break;
+        }
+
+        UnloadImage(asset->image);
+        UnloadWave(asset->wave);
+    }
+}